@@ -96,13 +96,16 @@ add_client(BufCompose clients/nrt/BufComposeClient.hpp CLASS NRTThreadedBufCompo
 add_client(BufFlatten clients/nrt/BufFlattenClient.hpp CLASS NRTThreadedBufFlattenClient )
 add_client(BufHPSS clients/rt/HPSSClient.hpp CLASS NRTThreadedHPSSClient )
 add_client(BufLoudness clients/rt/LoudnessClient.hpp CLASS NRTThreadedLoudnessClient )
+add_client(BufLoudnessMeter clients/nrt/BufLoudnessMeterClient.hpp CLASS NRTThreadedBufLoudnessMeterClient )
 add_client(BufMFCC clients/rt/MFCCClient.hpp CLASS NRTThreadedMFCCClient )
 add_client(BufMelBands clients/rt/MelBandsClient.hpp CLASS NRTThreadedMelBandsClient )
+add_client(BufMultiDescriptor clients/rt/MultiDescriptorClient.hpp CLASS NRTThreadedMultiDescriptorClient )
 add_client(BufNMF clients/nrt/NMFClient.hpp CLASS NRTThreadedNMFClient )
 add_client(BufNMFCross clients/nrt/NMFCrossClient.hpp CLASS NRTNMFCrossClient )
 add_client(BufNMFSeed clients/nrt/NMFSeedClient.hpp CLASS NRTThreadedNMFSeedClient )
 add_client(BufNoveltyFeature clients/rt/NoveltyFeatureClient.hpp CLASS NRTThreadedNoveltyFeatureClient )
 add_client(BufNoveltySlice clients/rt/NoveltySliceClient.hpp CLASS NRTThreadingNoveltySliceClient )
+add_client(BufOnlineNMF clients/nrt/OnlineNMFClient.hpp CLASS NRTThreadedOnlineNMFClient )
 add_client(BufOnsetFeature clients/rt/OnsetFeatureClient.hpp CLASS NRTThreadedOnsetFeatureClient )
 add_client(BufOnsetSlice clients/rt/OnsetSliceClient.hpp CLASS NRTThreadingOnsetSliceClient )
 add_client(BufPitch clients/rt/PitchClient.hpp CLASS NRTThreadedPitchClient )
@@ -122,8 +125,10 @@ add_client(Chroma clients/rt/ChromaClient.hpp CLASS RTChromaClient )
 add_client(Gain clients/rt/GainClient.hpp CLASS RTGainClient NOINSTALL)
 add_client(HPSS clients/rt/HPSSClient.hpp CLASS RTHPSSClient )
 add_client(Loudness clients/rt/LoudnessClient.hpp CLASS RTLoudnessClient )
+add_client(LoudnessMeter clients/rt/LoudnessMeterClient.hpp CLASS RTLoudnessMeterClient )
 add_client(MFCC clients/rt/MFCCClient.hpp CLASS RTMFCCClient )
 add_client(MelBands clients/rt/MelBandsClient.hpp CLASS RTMelBandsClient )
+add_client(MultiDescriptor clients/rt/MultiDescriptorClient.hpp CLASS RTMultiDescriptorClient )
 add_client(NMFFilter clients/rt/NMFFilterClient.hpp CLASS RTNMFFilterClient )
 add_client(NMFMatch clients/rt/NMFMatchClient.hpp CLASS RTNMFMatchClient )
 add_client(NMFMorph clients/rt/NMFMorphClient.hpp CLASS RTNMFMorphClient )
@@ -0,0 +1,19 @@
+/*
+Part of the Fluid Corpus Manipulation Project (http://www.flucoma.org/)
+Copyright 2017-2019 University of Huddersfield.
+Licensed under the BSD-3 License.
+See license.md file in the project root for full license information.
+This project has received funding from the European Research Council (ERC)
+under the European Union’s Horizon 2020 research and innovation programme
+(grant agreement No 725899).
+*/
+
+#include "FluidVersion.hpp"
+
+namespace fluid {
+namespace client {
+
+const char* fluidVersion() { return "1.0.5+sha.197fb61.core.sha.197fb61"; }
+
+} // namespace client
+} // namespace fluid
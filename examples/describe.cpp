@@ -15,13 +15,8 @@ to compute a summary of spectral features of an audio file
 
 #include <AudioFile/IAudioFile.h>
 #include <Eigen/Core>
-#include <algorithms/public/DCT.hpp>
-#include <algorithms/public/Loudness.hpp>
-#include <algorithms/public/MelBands.hpp>
-#include <algorithms/public/STFT.hpp>
-#include <algorithms/public/SpectralShape.hpp>
+#include <algorithms/public/MultiDescriptor.hpp>
 #include <algorithms/public/MultiStats.hpp>
-#include <algorithms/public/YINFFT.hpp>
 #include <data/FluidIndex.hpp>
 #include <data/TensorTypes.hpp>
 #include <cstdio>
@@ -87,69 +82,45 @@ int main(int argc, char* argv[])
   index minFreq = 20;
   index maxFreq = 5000;
 
-  STFT          stft{windowSize, fftSize, hopSize};
-  MelBands      bands{nBands, fftSize};
-  DCT           dct{nBands, nCoefs};
-  YINFFT        yin;
-  SpectralShape shape;
-  Loudness      loudness{windowSize};
-  MultiStats    stats;
+  MultiDescriptor descriptors{fftSize, nBands, nCoefs};
+  MultiStats      stats;
 
-  bands.init(minFreq, maxFreq, nBands, nBins, samplingRate, windowSize);
-  dct.init(nBands, nCoefs);
+  descriptors.init(windowSize, fftSize, nBands, nCoefs, samplingRate);
   stats.init(0, 0, 50, 100);
-  loudness.init(windowSize, samplingRate);
 
   RealVector in(nSamples);
   file.readChannel(in.data(), nSamples, 0);
   RealVector padded(in.size() + windowSize + hopSize);
   index      nFrames = floor((padded.size() - windowSize) / hopSize);
-  RealMatrix pitchMat(nFrames, 2);
-  RealMatrix loudnessMat(nFrames, 2);
-  RealMatrix mfccMat(nFrames, nCoefs);
-  RealMatrix shapeMat(nFrames, 7);
+  RealMatrix features(nFrames, MultiDescriptor::size(nBands, nCoefs));
   std::fill(padded.begin(), padded.end(), 0);
   padded(Slice(halfWindow, in.size())) <<= in;
 
   for (int i = 0; i < nFrames; i++)
   {
-    ComplexVector  frame(nBins);
-    RealVector     magnitude(nBins);
-    RealVector     mels(nBands);
-    RealVector     mfccs(nCoefs);
-    RealVector     pitch(2);
-    RealVector     shapeDesc(7);
-    RealVector     loudnessDesc(2);
     RealVectorView window = padded(fluid::Slice(i * hopSize, windowSize));
-    stft.processFrame(window, frame);
-    stft.magnitude(frame, magnitude);
-    bands.processFrame(magnitude, mels, false, false, true);
-    dct.processFrame(mels, mfccs);
-    mfccMat.row(i) <<= mfccs;
-    yin.processFrame(magnitude, pitch, minFreq, maxFreq, samplingRate);
-    pitchMat.row(i) <<= pitch;
-    shape.processFrame(magnitude, shapeDesc, samplingRate);
-    shapeMat.row(i) <<= shapeDesc;
-    loudness.processFrame(window, loudnessDesc, true, true);
-    loudnessMat.row(i) <<= loudnessDesc;
+    descriptors.processFrame(window, features.row(i), minFreq, maxFreq,
+                             minFreq, maxFreq, false, true, true,
+                             FluidDefaultAllocator());
   }
-  RealVector  pitchStats = computeStats(pitchMat, stats);
-  RealVector  loudnessStats = computeStats(loudnessMat, stats);
-  RealVector  shapeStats = computeStats(shapeMat, stats);
-  RealVector  mfccStats = computeStats(mfccMat, stats);
+  RealVector featureStats = computeStats(features, stats);
+  index      mfccOffset = nBands;
+  index      shapeOffset = mfccOffset + nCoefs;
+  index      pitchOffset = shapeOffset + MultiDescriptor::shapeSize;
+  index      loudnessOffset = pitchOffset + MultiDescriptor::pitchSize;
+  auto       column = [&](index i) { return featureStats(Slice(i * 7, 7)); };
   std::string colNames[] = {"Descriptor", "mean", "stdev", "skew",
                             "kurt",       "low",  "mid",   "high"};
   std::string shapeDescs[] = {"Centroid", "Spread",   "Skewness", "Kurtosis",
                               "Rolloff",  "Flatness", "Crest"};
   for (auto n : colNames) cout << setw(10) << n;
   cout << endl;
-  printRow("Pitch", pitchStats(Slice(0, 7)));
-  printRow("Pitch Conf.", pitchStats(Slice(7, 7)));
-  printRow("Loudness", loudnessStats(Slice(0, 7)));
-  printRow("True Peak", loudnessStats(Slice(7, 7)));
-  for (int i = 0; i < 7; i++)
-    printRow(shapeDescs[i], shapeStats(Slice(i * 7, 7)));
-  for (int i = 0; i < 13; i++)
-    printRow("MFCC" + std::to_string(i), mfccStats(Slice(i * 7, 7)));
+  printRow("Pitch", column(pitchOffset));
+  printRow("Pitch Conf.", column(pitchOffset + 1));
+  printRow("Loudness", column(loudnessOffset));
+  printRow("True Peak", column(loudnessOffset + 1));
+  for (int i = 0; i < 7; i++) printRow(shapeDescs[i], column(shapeOffset + i));
+  for (int i = 0; i < nCoefs; i++)
+    printRow("MFCC" + std::to_string(i), column(mfccOffset + i));
   return 0;
 }
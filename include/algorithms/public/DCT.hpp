@@ -11,48 +11,80 @@ under the European Union’s Horizon 2020 research and innovation programme
 #pragma once
 
 #include "../util/AlgorithmUtils.hpp"
+#include "../util/FFT.hpp"
 #include "../util/FluidEigenMappings.hpp"
 #include "../../data/FluidIndex.hpp"
 #include "../../data/FluidMemory.hpp"
 #include "../../data/TensorTypes.hpp"
 #include <Eigen/Core>
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
 namespace fluid {
 namespace algorithm {
 
+/// Orthonormal DCT-II. Small transforms multiply by a precomputed cosine
+/// table; once the table would exceed maxTableSize entries, the transform is
+/// computed in O(n log n) as a Bluestein chirp convolution on power-of-two
+/// real FFTs, so arbitrary (e.g. 2^k + 1 bin) sizes are supported. Where the
+/// convolution would need a bigger FFT than FFT::maxFFTSize, the outputs are
+/// computed in blocks that each fit
 class DCT
 {
 public:
   using ArrayXd = Eigen::ArrayXd;
+  using ArrayXcd = Eigen::ArrayXcd;
   using MatrixXd = Eigen::MatrixXd;
 
+  static constexpr index maxTableSize = 4096;
+
   DCT(index maxInputSize, index maxOutputSize,
       Allocator& alloc = FluidDefaultAllocator())
-      : mTable{maxOutputSize, maxInputSize, alloc}
-  {}
+      : mMaxInputSize{maxInputSize}, mMaxOutputSize{maxOutputSize},
+        mTable(std::min(maxInputSize * maxOutputSize, maxTableSize), alloc),
+        mFFT(convolutionSize(maxInputSize, maxOutputSize), alloc),
+        mIFFT(convolutionSize(maxInputSize, maxOutputSize), alloc),
+        mChirpCos(maxInputSize, alloc), mChirpSin(maxInputSize, alloc),
+        mPostCos(maxOutputSize, alloc), mPostSin(maxOutputSize, alloc),
+        mReal(convolutionSize(maxInputSize, maxOutputSize), alloc),
+        mImag(convolutionSize(maxInputSize, maxOutputSize), alloc),
+        mKernelReal(kernelSize(maxInputSize, maxOutputSize), alloc),
+        mKernelImag(kernelSize(maxInputSize, maxOutputSize), alloc),
+        mInputReal(convolutionSize(maxInputSize, maxOutputSize) / 2 + 1, alloc),
+        mInputImag(convolutionSize(maxInputSize, maxOutputSize) / 2 + 1, alloc),
+        mSpectrum(convolutionSize(maxInputSize, maxOutputSize) / 2 + 1, alloc),
+        mConvolved(convolutionSize(maxInputSize, maxOutputSize) / 2 + 1, alloc)
+  {
+    assert(maxInputSize < FFT::maxFFTSize && "DCT: input size too large");
+  }
 
   void init(index inputSize, index outputSize,
       Allocator& alloc = FluidDefaultAllocator())
   {
     using namespace std;
     assert(inputSize >= outputSize);
-    assert(inputSize <= mTable.cols());
-    assert(outputSize <= mTable.rows());
+    assert(inputSize <= mMaxInputSize);
+    assert(outputSize <= mMaxOutputSize);
 
     mInputSize = inputSize;
     mOutputSize = outputSize;
-    mTable.setZero();
+    mUseTable = inputSize * outputSize <= maxTableSize;
 
-    ScopedEigenMap<ArrayXd> freqs(inputSize, alloc);
-    for (index i = 0; i < mOutputSize; i++)
+    if (mUseTable)
     {
-      double scale = i == 0 ? 1.0 / sqrt(inputSize) : sqrt(2.0 / inputSize);
-      freqs = ((pi / inputSize) * i) *
-              ArrayXd::LinSpaced(inputSize, 0.5, inputSize - 0.5);
-      mTable.topLeftCorner(outputSize, inputSize).row(i) = freqs.cos() * scale;
+      Eigen::Map<MatrixXd>    table(mTable.data(), outputSize, inputSize);
+      ScopedEigenMap<ArrayXd> freqs(inputSize, alloc);
+      for (index i = 0; i < mOutputSize; i++)
+      {
+        freqs = ((pi / inputSize) * i) *
+                ArrayXd::LinSpaced(inputSize, 0.5, inputSize - 0.5);
+        table.row(i) = freqs.cos() * scale(i);
+      }
     }
+    else
+      initConvolution();
+
     mInitialized = true;
   }
 
@@ -64,22 +96,159 @@ public:
     assert(out.size() == mOutputSize &&
            "DCT: actual output size doesn't maatch expected size");
 
-    FluidEigenMap<Eigen::Matrix> frame = _impl::asEigen<Eigen::Matrix>(in);
-    _impl::asEigen<Eigen::Matrix>(out).noalias() =
-        (mTable.topLeftCorner(mOutputSize, mInputSize) * frame);
+    FluidEigenMap<Eigen::Array> frame = _impl::asEigen<Eigen::Array>(in);
+    FluidEigenMap<Eigen::Array> result = _impl::asEigen<Eigen::Array>(out);
+    process(frame.col(0), result.col(0));
   }
 
   void processFrame(Eigen::Ref<const ArrayXd> input, Eigen::Ref<ArrayXd> output)
   {
-    output.matrix().noalias() =
-        (mTable.topLeftCorner(mOutputSize, mInputSize) * input.matrix());
+    process(input, output);
   }
 
 private:
+  // outputs per convolution, so that each fits in the largest FFT
+  static index blockSize(index inputSize, index outputSize)
+  {
+    return std::min(outputSize, FFT::maxFFTSize - inputSize + 1);
+  }
+
+  static index numBlocks(index inputSize, index outputSize)
+  {
+    index block = blockSize(inputSize, outputSize);
+    return (outputSize + block - 1) / block;
+  }
+
+  static index convolutionSize(index inputSize, index outputSize)
+  {
+    index size = 2;
+    while (size < inputSize + blockSize(inputSize, outputSize) - 1) size *= 2;
+    return size;
+  }
+
+  // one kernel spectrum per block
+  static index kernelSize(index inputSize, index outputSize)
+  {
+    return numBlocks(inputSize, outputSize) *
+           (convolutionSize(inputSize, outputSize) / 2 + 1);
+  }
+
+  double scale(index i) const
+  {
+    return i == 0 ? 1.0 / std::sqrt(mInputSize) : std::sqrt(2.0 / mInputSize);
+  }
+
+  // angle of the chirp exp(i * pi * n^2 / 2N); n^2 is reduced modulo the
+  // chirp's period 4N first so large n don't lose precision
+  double chirpAngle(index n2) const
+  {
+    return pi * static_cast<double>(n2 % (4 * mInputSize)) / (2 * mInputSize);
+  }
+
+  // X_k = Re(exp(-i pi k / 2N) sum_n x_n exp(-i pi k n / N)), and
+  // kn = (k^2 + n^2 - (k - n)^2) / 2 turns the sum into a convolution of
+  // x_n exp(-i pi n^2 / 2N) with the chirp exp(i pi m^2 / 2N). Both are
+  // complex, so the convolution is done as real FFTs of the real and
+  // imaginary parts. A block of outputs starting at k0 convolves with the
+  // chirp shifted by k0
+  void initConvolution()
+  {
+    index N = mInputSize;
+    index K = mOutputSize;
+    index size = convolutionSize(N, K);
+    index bins = size / 2 + 1;
+    index block = blockSize(N, K);
+    mFFT.resize(size);
+    mIFFT.resize(size);
+
+    for (index n = 0; n < N; n++)
+    {
+      mChirpCos(n) = std::cos(chirpAngle(n * n));
+      mChirpSin(n) = std::sin(chirpAngle(n * n));
+    }
+
+    for (index b = 0; b < numBlocks(N, K); b++)
+    {
+      index k0 = b * block;
+      mReal.head(size).setZero();
+      mImag.head(size).setZero();
+      for (index m = -(N - 1); m < block; m++)
+      {
+        index pos = (m + size) % size;
+        mReal(pos) = std::cos(chirpAngle((k0 + m) * (k0 + m)));
+        mImag(pos) = std::sin(chirpAngle((k0 + m) * (k0 + m)));
+      }
+      mKernelReal.segment(b * bins, bins) = mFFT.process(mReal.head(size));
+      mKernelImag.segment(b * bins, bins) = mFFT.process(mImag.head(size));
+    }
+
+    // fold the output chirp, the half-sample phase shift, the normalisation
+    // and the IFFT's scaling into one complex factor per coefficient
+    for (index k = 0; k < K; k++)
+    {
+      double angle = -chirpAngle(k * k + k);
+      mPostCos(k) = scale(k) * std::cos(angle) / size;
+      mPostSin(k) = scale(k) * std::sin(angle) / size;
+    }
+  }
+
+  template <typename InputType, typename OutputType>
+  void process(const InputType& input, OutputType&& output)
+  {
+    index N = mInputSize;
+    index K = mOutputSize;
+
+    if (mUseTable)
+    {
+      Eigen::Map<const MatrixXd> table(mTable.data(), K, N);
+      output.matrix().noalias() = table * input.matrix();
+      return;
+    }
+
+    index bins = convolutionSize(N, K) / 2 + 1;
+    index block = blockSize(N, K);
+    mReal.head(N) = input * mChirpCos.head(N);
+    mImag.head(N) = -input * mChirpSin.head(N);
+    mInputReal.head(bins) = mFFT.process(mReal.head(N));
+    mInputImag.head(bins) = mFFT.process(mImag.head(N));
+    for (index k0 = 0, b = 0; k0 < K; k0 += block, b++)
+    {
+      index n = std::min(block, K - k0);
+      auto  kernelReal = mKernelReal.segment(b * bins, bins);
+      auto  kernelImag = mKernelImag.segment(b * bins, bins);
+      mConvolved.head(bins) = mInputReal.head(bins) * kernelImag +
+                              mInputImag.head(bins) * kernelReal;
+      mSpectrum.head(bins) = mInputReal.head(bins) * kernelReal -
+                             mInputImag.head(bins) * kernelImag;
+      mReal.head(n) = mIFFT.process(mSpectrum.head(bins)).head(n);
+      output.segment(k0, n) =
+          mPostCos.segment(k0, n) * mReal.head(n) -
+          mPostSin.segment(k0, n) *
+              mIFFT.process(mConvolved.head(bins)).head(n);
+    }
+  }
+
   index                    mInputSize{40};
   index                    mOutputSize{13};
+  index                    mMaxInputSize;
+  index                    mMaxOutputSize;
+  bool                     mUseTable{true};
   bool                     mInitialized{false};
-  ScopedEigenMap<MatrixXd> mTable;
+  ScopedEigenMap<ArrayXd>  mTable;
+  FFT                      mFFT;
+  IFFT                     mIFFT;
+  ScopedEigenMap<ArrayXd>  mChirpCos;
+  ScopedEigenMap<ArrayXd>  mChirpSin;
+  ScopedEigenMap<ArrayXd>  mPostCos;
+  ScopedEigenMap<ArrayXd>  mPostSin;
+  ScopedEigenMap<ArrayXd>  mReal;
+  ScopedEigenMap<ArrayXd>  mImag;
+  ScopedEigenMap<ArrayXcd> mKernelReal;
+  ScopedEigenMap<ArrayXcd> mKernelImag;
+  ScopedEigenMap<ArrayXcd> mInputReal;
+  ScopedEigenMap<ArrayXcd> mInputImag;
+  ScopedEigenMap<ArrayXcd> mSpectrum;
+  ScopedEigenMap<ArrayXcd> mConvolved;
 };
 } // namespace algorithm
 } // namespace fluid
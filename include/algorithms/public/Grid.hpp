@@ -16,8 +16,12 @@ under the European Union’s Horizon 2020 research and innovation programme
 #include "../util/Munkres.hpp"
 #include "../../data/TensorTypes.hpp"
 #include <Eigen/Core>
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
 
 namespace fluid {
 namespace algorithm {
@@ -27,10 +31,15 @@ class Grid
 public:
   using MatrixXd = Eigen::MatrixXd;
   using VectorXd = Eigen::VectorXd;
+  using ArrayXd = Eigen::ArrayXd;
+  using ArrayXXd = Eigen::ArrayXXd;
   using DataSet = FluidDataSet<std::string, double, 1>;
 
+  // above this many points the dense exact assignment gets impractical
+  static constexpr index maxExactSize = 2000;
+
   DataSet process(DataSet& in, index overSample = 1, index extent = 0,
-                  index axis = 0)
+                  index axis = 0, bool exact = true)
   {
     using namespace Eigen;
     using namespace _impl;
@@ -82,10 +91,30 @@ public:
     ArrayXd  yPos = yMin + (rowPos / (numRows - 1)) * (yMax - yMin);
     ArrayXXd grid(M, 2);
     grid << xPos, yPos;
-    ArrayXXd cost = algorithm::DistanceMatrix<ArrayXXd>(data, grid, 1);
-    ArrayXidx  assignment(N);
-    bool     outcome = assign2D.process(cost, assignment);
-    if (!outcome) return DataSet();
+    ArrayXidx assignment(N);
+    if (exact)
+    {
+      ArrayXXd cost = algorithm::DistanceMatrix<ArrayXXd>(data, grid, 1);
+      bool     outcome = assign2D.process(cost, assignment);
+      if (!outcome) return DataSet();
+    }
+    else
+    {
+      std::vector<index> points(asUnsigned(N)), cells(asUnsigned(M));
+      std::iota(points.begin(), points.end(), 0);
+      std::iota(cells.begin(), cells.end(), 0);
+      if (!assignHierarchical(data, grid, points.begin(), points.end(),
+                              cells.begin(), cells.end(), assignment))
+        return DataSet();
+      auto cellAt = [&](index col, index row) -> index {
+        if (col < 0 || row < 0 || col >= numCols) return -1;
+        if (extent > 0 && axis == 1 && row >= numRows) return -1;
+        index cell = (extent > 0 && axis == 1) ? col * numRows + row
+                                               : row * numCols + col;
+        return cell < M ? cell : -1;
+      };
+      refine(data, grid, colPos, rowPos, cellAt, assignment);
+    }
 
     DataSet    result(2);
     auto       ids = in.getIds();
@@ -101,6 +130,116 @@ public:
   }
 
 private:
+  using Iterator = std::vector<index>::iterator;
+
+  // Recursive bisection: split the cells in half along their wider axis,
+  // give each half a share of the points proportional to its share of the
+  // cells (picking points by the same coordinate), and solve small enough
+  // blocks exactly
+  bool assignHierarchical(const ArrayXXd& data, const ArrayXXd& grid,
+                          Iterator pointsBegin, Iterator pointsEnd,
+                          Iterator cellsBegin, Iterator cellsEnd,
+                          ArrayXidx& assignment)
+  {
+    using namespace Eigen;
+    index numPoints = std::distance(pointsBegin, pointsEnd);
+    index numCells = std::distance(cellsBegin, cellsEnd);
+    if (numPoints == 0) return true;
+
+    if (numPoints <= leafSize)
+    {
+      ArrayXXd leafData(numPoints, 2), leafGrid(numCells, 2);
+      for (index i = 0; i < numPoints; i++)
+        leafData.row(i) = data.row(pointsBegin[i]);
+      for (index i = 0; i < numCells; i++)
+        leafGrid.row(i) = grid.row(cellsBegin[i]);
+      ArrayXXd  cost = algorithm::DistanceMatrix<ArrayXXd>(leafData, leafGrid, 1);
+      ArrayXidx leafAssignment(numPoints);
+      if (!assign2D.process(cost, leafAssignment)) return false;
+      for (index i = 0; i < numPoints; i++)
+        assignment(pointsBegin[i]) = cellsBegin[leafAssignment(i)];
+      return true;
+    }
+
+    double xMin = std::numeric_limits<double>::max(), xMax = -xMin;
+    double yMin = xMin, yMax = -xMin;
+    std::for_each(cellsBegin, cellsEnd, [&](index c) {
+      xMin = std::min(xMin, grid(c, 0));
+      xMax = std::max(xMax, grid(c, 0));
+      yMin = std::min(yMin, grid(c, 1));
+      yMax = std::max(yMax, grid(c, 1));
+    });
+    index split = (xMax - xMin) >= (yMax - yMin) ? 0 : 1;
+    index other = 1 - split;
+
+    index    numLowCells = numCells / 2;
+    Iterator cellsMid = cellsBegin + numLowCells;
+    std::nth_element(cellsBegin, cellsMid, cellsEnd, [&](index a, index b) {
+      return grid(a, split) < grid(b, split) ||
+             (grid(a, split) == grid(b, split) &&
+              grid(a, other) < grid(b, other));
+    });
+
+    index numLowPoints = lrint(static_cast<double>(numPoints) * numLowCells /
+                               static_cast<double>(numCells));
+    numLowPoints = std::max(numLowPoints, numPoints - (numCells - numLowCells));
+    numLowPoints = std::min(numLowPoints, numLowCells);
+    Iterator pointsMid = pointsBegin + numLowPoints;
+    std::nth_element(pointsBegin, pointsMid, pointsEnd,
+                     [&](index a, index b) {
+                       return data(a, split) < data(b, split);
+                     });
+
+    return assignHierarchical(data, grid, pointsBegin, pointsMid, cellsBegin,
+                              cellsMid, assignment) &&
+           assignHierarchical(data, grid, pointsMid, pointsEnd, cellsMid,
+                              cellsEnd, assignment);
+  }
+
+  // Local refinement across block boundaries: swap a point with the
+  // occupant (or emptiness) of a neighbouring cell whenever that lowers the
+  // total distance, until a pass makes no change
+  template <typename CellAt>
+  void refine(const ArrayXXd& data, const ArrayXXd& grid, const ArrayXd& colPos,
+              const ArrayXd& rowPos, CellAt&& cellAt, ArrayXidx& assignment)
+  {
+    ArrayXidx owner = ArrayXidx::Constant(grid.rows(), -1);
+    for (index i = 0; i < assignment.size(); i++) owner(assignment(i)) = i;
+    auto cost = [&](index point, index cell) {
+      return std::sqrt((data.row(point) - grid.row(cell)).square().sum());
+    };
+    constexpr index neighbours[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    for (index pass = 0; pass < maxRefinePasses; pass++)
+    {
+      bool changed = false;
+      for (index i = 0; i < assignment.size(); i++)
+      {
+        for (auto& offset : neighbours)
+        {
+          index a = assignment(i);
+          index b = cellAt(lrint(colPos(a)) + offset[0],
+                           lrint(rowPos(a)) + offset[1]);
+          if (b < 0) continue;
+          index  j = owner(b);
+          double before = cost(i, a) + (j >= 0 ? cost(j, b) : 0);
+          double after = cost(i, b) + (j >= 0 ? cost(j, a) : 0);
+          if (after < before - epsilon)
+          {
+            assignment(i) = b;
+            owner(b) = i;
+            owner(a) = j;
+            if (j >= 0) assignment(j) = a;
+            changed = true;
+          }
+        }
+      }
+      if (!changed) break;
+    }
+  }
+
+  static constexpr index leafSize = 256;
+  static constexpr index maxRefinePasses = 8;
+
   Assign2D assign2D;
 };
 }// namespace algorithm
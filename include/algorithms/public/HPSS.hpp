@@ -35,9 +35,9 @@ public:
         mHBuf(asUnsigned(mMaxBins *  maxHSize), 0, alloc),
         mVBuf(asUnsigned(mMaxBins *  maxHSize), 0, alloc),
         mFrameBuf(asUnsigned(mMaxBins * maxHSize), 0,  alloc),
-        mPaddedBuf(asUnsigned(mMaxBins * 3), 0, alloc),
         mHFilters(asUnsigned(mMaxBins),MedianFilter(mMaxHSize, alloc), alloc),
         mVFilter(mMaxBins, alloc),
+        mMagnitudeBuf(asUnsigned(mMaxBins), alloc),
         mHarmMaskBuf(asUnsigned(mMaxBins),alloc),
         mPercMaskBuf(asUnsigned(mMaxBins),alloc),
         mResMaskBuf(asUnsigned(mMaxBins),alloc),
@@ -58,6 +58,7 @@ public:
     h.setZero();
     v.setZero();
     buf.setZero();
+    mHead = 0;
 
     for (index i = 0; i < nBins; i++) { mHFilters[asUnsigned(i)].init(hSize); }
     mInitialized = true;
@@ -76,33 +77,34 @@ public:
     assert(in.size() <= mMaxBins);
 
     index    h2 = (hSize - 1) / 2;
-    index    v2 = (vSize - 1) / 2;
     index    nBins = in.size();
 
     ArrayXXMap v(mVBuf.data(),nBins, hSize);
     ArrayXXMap h(mHBuf.data(),nBins,hSize);
     ArrayXXcMap buf(mFrameBuf.data(),nBins,hSize);
     
-    v.block(0, 0, nBins, hSize - 1) = v.block(0, 1, nBins, hSize - 1);
-    h.block(0, 0, nBins, hSize - 1) = h.block(0, 1, nBins, hSize - 1);
-    buf.block(0, 0, nBins, hSize - 1) = buf.block(0, 1, nBins, hSize - 1);
-    
-    ArrayXMap padded(mPaddedBuf.data(),2 * vSize + nBins);
-    padded.setZero();
+    // histories are rings of hSize columns: advancing mHead drops the oldest
+    // frame, and column (mHead + j) % hSize holds the frame j steps after it
+    mHead = mHead + 1 == hSize ? 0 : mHead + 1;
+    index newest = mHead == 0 ? hSize - 1 : mHead - 1;
+    index hCol = (mHead + h2 + 1) % hSize;
 
-    padded.segment(v2, nBins) = _impl::asEigen<Array>(in).abs().real();
-    mVFilter.init(vSize);
-    for (index i = 0; i < padded.size(); i++)
-    {
-      padded(i) = mVFilter.processSample(padded(i));
-    }
+    // vertical median of bins [b, b + vSize) for each bin b
+    if (mVFilter.size() != vSize) mVFilter.init(vSize);
+    ArrayXMap magnitude(mMagnitudeBuf.data(), nBins);
+    magnitude = _impl::asEigen<Array>(in).abs();
+    mVFilter.process(
+        FluidTensorView<const double, 1>(magnitude.data(), 0, nBins),
+        FluidTensorView<double, 1>(&v(0, newest), 0, nBins), vSize - 1);
+
+    buf.col(newest) = _impl::asEigen<Array>(in);
+    for (index i = 0; i < nBins; i++)
+      h(i, hCol) = mHFilters[asUnsigned(i)].processSample(magnitude(i));
+
+    auto hOld = h.col(mHead);
+    auto vOld = v.col(mHead);
+    auto bufOld = buf.col(mHead);
 
-    v.block(0, hSize - 1, nBins, 1) = padded.segment(v2 * 3, nBins);
-    buf.block(0, hSize - 1, nBins, 1) = _impl::asEigen<Array>(in);
-    h.block(0, h2 + 1, nBins, 1) = ArrayXd::NullaryExpr(nBins,[&in,this](int i){
-       return mHFilters[asUnsigned(i)].processSample(std::abs(in(i)));
-    });
-    
     ArrayXMap harmonicMask(mHarmMaskBuf.data(),nBins);
     ArrayXMap percussiveMask(mPercMaskBuf.data(),nBins);
     ArrayXMap residualMask(mResMaskBuf.data(),nBins);
@@ -112,13 +114,13 @@ public:
     {
     case kClassic: {
       ArrayXMap mult(mMaskNormBuf.data(),nBins);
-      mult  = (1.0 / (h.col(0) + v.col(0)).max(epsilon));
-      harmonicMask = (h.col(0) * mult);
-      percussiveMask = (v.col(0) * mult);
+      mult  = (1.0 / (hOld + vOld).max(epsilon));
+      harmonicMask = (hOld * mult);
+      percussiveMask = (vOld * mult);
       break;
     }
     case kCoupled: {
-      harmonicMask = ((h.col(0) / v.col(0)) >
+      harmonicMask = ((hOld / vOld) >
                       makeThreshold(nBins, hThresholdX1, hThresholdY1,
                                     hThresholdX2, hThresholdY2))
                          .cast<double>();
@@ -126,11 +128,11 @@ public:
       break;
     }
     case kAdvanced: {
-      harmonicMask = ((h.col(0) / v.col(0)) >
+      harmonicMask = ((hOld / vOld) >
                       makeThreshold(nBins, hThresholdX1, hThresholdY1,
                                     hThresholdX2, hThresholdY2))
                          .cast<double>();
-      percussiveMask = ((v.col(0) / h.col(0)) >
+      percussiveMask = ((vOld / hOld) >
                         makeThreshold(nBins, pThresholdX1, pThresholdY1,
                                       pThresholdX2, pThresholdY2))
                            .cast<double>();
@@ -146,9 +148,9 @@ public:
       break;
     }
     }
-    _impl::asEigen<Array>(out).col(0) = buf.col(0) * harmonicMask.min(1.0);
-    _impl::asEigen<Array>(out).col(1) = buf.col(0) * percussiveMask.min(1.0);
-    _impl::asEigen<Array>(out).col(2) = buf.col(0) * residualMask.min(1.0);
+    _impl::asEigen<Array>(out).col(0) = bufOld * harmonicMask.min(1.0);
+    _impl::asEigen<Array>(out).col(1) = bufOld * percussiveMask.min(1.0);
+    _impl::asEigen<Array>(out).col(2) = bufOld * residualMask.min(1.0);
   }
   
   bool initialized() { return mInitialized; }
@@ -178,14 +180,15 @@ private:
   Container<double>               mHBuf;
   Container<double>               mVBuf;
   Container<std::complex<double>> mFrameBuf;
-  Container<double>               mPaddedBuf;
   Container<MedianFilter>         mHFilters;
   MedianFilter                   mVFilter;
+  Container<double>               mMagnitudeBuf;
   Container<double>               mHarmMaskBuf;
   Container<double>               mPercMaskBuf;
   Container<double>               mResMaskBuf;
   Container<double>               mMaskNormBuf;
   Container<double>               mMaskThreshBuf;
+  index                          mHead{0};
   bool                           mInitialized{false};
 };
 } // namespace algorithm
@@ -28,7 +28,7 @@ class Loudness
 
 public:
   Loudness(index maxSize, Allocator& alloc = FluidDefaultAllocator())
-      : mTP(maxSize, alloc)
+      : mTP(maxSize, alloc), mFilter(1, alloc), mFiltered(maxSize, alloc)
   {}
 
   void init(
@@ -49,10 +49,12 @@ public:
     assert(output.size() == 2);
     assert(input.size() == mSize);
     FluidEigenMap<Eigen::Array> in = _impl::asEigen<Array>(input);
-    ScopedEigenMap<ArrayXd>     filtered(mSize, alloc);
-    for (index i = 0; i < mSize; i++)
-      filtered(i) = weighting ? mFilter.processSample(input(i)) : input(i);
-    double loudness = -0.691 + 10 * log10(filtered.square().mean() + epsilon);
+    auto                        filtered = mFiltered(Slice(0, mSize));
+    filtered <<= input;
+    if (weighting) mFilter.process(filtered);
+    double loudness =
+        -0.691 +
+        10 * log10(_impl::asEigen<Array>(filtered).square().mean() + epsilon);
     double peak =
         truePeak ? mTP.processFrame(input, alloc) : in.abs().maxCoeff();
     peak = 20 * log10(peak + epsilon);
@@ -61,10 +63,11 @@ public:
   }
 
 private:
-  TruePeak         mTP;
-  KWeightingFilter mFilter;
-  index            mSize{1024};
-  bool             mInitialized{false};
+  TruePeak               mTP;
+  KWeightingFilter       mFilter;
+  FluidTensor<double, 1> mFiltered;
+  index                  mSize{1024};
+  bool                   mInitialized{false};
 };
 
 } // namespace algorithm
@@ -0,0 +1,248 @@
+/*
+Part of the Fluid Corpus Manipulation Project (http://www.flucoma.org/)
+Copyright 2017-2019 University of Huddersfield.
+Licensed under the BSD-3 License.
+See license.md file in the project root for full license information.
+This project has received funding from the European Research Council (ERC)
+under the European Union’s Horizon 2020 research and innovation programme
+(grant agreement No 725899).
+*/
+
+#pragma once
+
+#include "../util/AlgorithmUtils.hpp"
+#include "../util/FluidEigenMappings.hpp"
+#include "../util/KWeightingFilter.hpp"
+#include "../../data/FluidIndex.hpp"
+#include "../../data/FluidMemory.hpp"
+#include "../../data/FluidTensor.hpp"
+#include "../../data/TensorTypes.hpp"
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace fluid {
+namespace algorithm {
+
+/// Streaming EBU R128 / BS.1770 loudness meter. Input is K-weighted and
+/// accumulated in 100ms sub-blocks; momentary (400ms) and short-term (3s)
+/// loudness come from a ring of the last 30 sub-blocks. Gated integrated
+/// loudness and loudness range are kept as histograms of 400ms and 3s block
+/// loudness in 0.1 LU bins, so every update costs the same however long the
+/// meter has been running. Channels are summed with unit weights
+class LoudnessMeter
+{
+  static constexpr index  nSubBlocks = 30; // 3s of 100ms sub-blocks
+  static constexpr index  nMomentary = 4;  // 400ms
+  static constexpr index  chunkSize = 256;
+  static constexpr index  nBins = 1000;
+  static constexpr double binWidth = 0.1;
+
+public:
+  static constexpr double absoluteGate = -70;
+  static constexpr double integratedGate = -10;
+  static constexpr double rangeGate = -20;
+
+  LoudnessMeter(index maxChannels, Allocator& alloc = FluidDefaultAllocator())
+      : mFilter(maxChannels, alloc), mChunk(chunkSize, maxChannels, alloc),
+        mMaxChannels(maxChannels)
+  {}
+
+  void init(index channels, double sampleRate)
+  {
+    assert(channels <= mMaxChannels);
+    mChannels = channels;
+    mSampleRate = sampleRate;
+    mSubBlockSize = std::max<index>(std::lrint(0.1 * sampleRate), 1);
+    reset();
+    mInitialized = true;
+  }
+
+  void reset()
+  {
+    mFilter.init(mSampleRate);
+    mSubBlocks.fill(0);
+    mBlockEnergy.fill(0);
+    mBlockCount.fill(0);
+    mRangeCount.fill(0);
+    mHead = 0;
+    mNumSubBlocks = 0;
+    mFill = 0;
+    mEnergy = 0;
+    mGatedEnergy = 0;
+    mGatedBlocks = 0;
+    mRangeEnergy = 0;
+    mRangeBlocks = 0;
+    mMomentary = mShortTerm = toLoudness(0);
+    mMaxMomentary = mMaxShortTerm = toLoudness(0);
+  }
+
+  /// channels x frames, any length
+  void processBlock(FluidTensorView<const double, 2> input)
+  {
+    assert(mInitialized);
+    assert(input.rows() == mChannels);
+    for (index pos = 0; pos < input.cols();)
+    {
+      index n = std::min({chunkSize, input.cols() - pos, mSubBlockSize - mFill});
+      auto  chunk = mChunk(Slice(0, n), Slice(0, mChannels));
+      _impl::asEigen<Eigen::Array>(chunk) =
+          _impl::asEigen<Eigen::Array>(
+              input(Slice(0, mChannels), Slice(pos, n)))
+              .transpose();
+      mFilter.process(chunk);
+      mEnergy += _impl::asEigen<Eigen::Array>(chunk).square().sum();
+      mFill += n;
+      pos += n;
+      if (mFill == mSubBlockSize) completeSubBlock();
+    }
+  }
+
+  double momentary() const { return mMomentary; }
+  double shortTerm() const { return mShortTerm; }
+  double maxMomentary() const { return mMaxMomentary; }
+  double maxShortTerm() const { return mMaxShortTerm; }
+
+  /// gated integrated loudness over everything since the last reset().
+  /// Block loudness is only kept to the nearest bin, so the whole bin holding
+  /// the relative gate is counted: blocks up to 0.1 LU below the gate can be
+  /// included. This is a known approximation to BS.1770, which only differs
+  /// when blocks land in that one bin
+  double integrated() const
+  {
+    if (mGatedBlocks == 0) return toLoudness(0);
+    index  start = bin(toLoudness(mGatedEnergy / mGatedBlocks) + integratedGate);
+    double energy = 0;
+    index  count = 0;
+    for (index i = start; i < nBins; i++)
+    {
+      energy += mBlockEnergy[asUnsigned(i)];
+      count += mBlockCount[asUnsigned(i)];
+    }
+    return count ? toLoudness(energy / count) : toLoudness(0);
+  }
+
+  /// loudness range (EBU Tech 3342): spread between the 10th and 95th
+  /// percentiles of gated short-term loudness
+  double range() const
+  {
+    if (mRangeBlocks == 0) return 0;
+    index start = bin(toLoudness(mRangeEnergy / mRangeBlocks) + rangeGate);
+    index count = 0;
+    for (index i = start; i < nBins; i++) count += mRangeCount[asUnsigned(i)];
+    if (count == 0) return 0;
+    index  lowRank = std::lrint(0.1 * (count - 1));
+    index  highRank = std::lrint(0.95 * (count - 1));
+    double low = 0, high = 0;
+    for (index i = start, seen = 0; i < nBins; i++)
+    {
+      index c = mRangeCount[asUnsigned(i)];
+      if (seen <= lowRank && lowRank < seen + c) low = binCentre(i);
+      if (seen <= highRank && highRank < seen + c)
+      {
+        high = binCentre(i);
+        break;
+      }
+      seen += c;
+    }
+    return high - low;
+  }
+
+  bool initialized() const { return mInitialized; }
+
+private:
+  static double toLoudness(double energy)
+  {
+    return -0.691 + 10 * std::log10(energy + epsilon);
+  }
+
+  static index bin(double loudness)
+  {
+    index i = static_cast<index>(std::floor((loudness - absoluteGate) / binWidth));
+    return std::clamp<index>(i, 0, nBins - 1);
+  }
+
+  static double binCentre(index i)
+  {
+    return absoluteGate + (static_cast<double>(i) + 0.5) * binWidth;
+  }
+
+  double meanOfLast(index n) const
+  {
+    double sum = 0;
+    for (index i = 1; i <= n; i++)
+      sum += mSubBlocks[asUnsigned((mHead - i + nSubBlocks) % nSubBlocks)];
+    return sum / n;
+  }
+
+  void completeSubBlock()
+  {
+    mSubBlocks[asUnsigned(mHead)] = mEnergy / mSubBlockSize;
+    mHead = (mHead + 1) % nSubBlocks;
+    mNumSubBlocks++;
+    mEnergy = 0;
+    mFill = 0;
+
+    double momentary = meanOfLast(nMomentary);
+    double shortTerm = meanOfLast(nSubBlocks);
+    mMomentary = toLoudness(momentary);
+    mShortTerm = toLoudness(shortTerm);
+
+    // gating blocks overlap by 75%, so there is one per sub-block once the
+    // first 400ms is complete
+    if (mNumSubBlocks >= nMomentary)
+    {
+      mMaxMomentary = std::max(mMaxMomentary, mMomentary);
+      if (mMomentary >= absoluteGate)
+      {
+        index b = bin(mMomentary);
+        mBlockEnergy[asUnsigned(b)] += momentary;
+        mBlockCount[asUnsigned(b)]++;
+        mGatedEnergy += momentary;
+        mGatedBlocks++;
+      }
+    }
+
+    if (mNumSubBlocks >= nSubBlocks)
+    {
+      mMaxShortTerm = std::max(mMaxShortTerm, mShortTerm);
+      if (mShortTerm >= absoluteGate)
+      {
+        mRangeCount[asUnsigned(bin(mShortTerm))]++;
+        mRangeEnergy += shortTerm;
+        mRangeBlocks++;
+      }
+    }
+  }
+
+  KWeightingFilter       mFilter;
+  FluidTensor<double, 2> mChunk;
+  index                  mMaxChannels;
+  index                  mChannels{1};
+  double                 mSampleRate{44100};
+  index                  mSubBlockSize{4410};
+  bool                   mInitialized{false};
+
+  std::array<double, nSubBlocks> mSubBlocks;
+  index                          mHead{0};
+  index                          mNumSubBlocks{0};
+  index                          mFill{0};
+  double                         mEnergy{0};
+
+  std::array<double, nBins> mBlockEnergy;
+  std::array<index, nBins>  mBlockCount;
+  std::array<index, nBins>  mRangeCount;
+  double                    mGatedEnergy{0};
+  index                     mGatedBlocks{0};
+  double                    mRangeEnergy{0};
+  index                     mRangeBlocks{0};
+
+  double mMomentary{0};
+  double mShortTerm{0};
+  double mMaxMomentary{0};
+  double mMaxShortTerm{0};
+};
+
+} // namespace algorithm
+} // namespace fluid
@@ -14,9 +14,13 @@ under the European Union’s Horizon 2020 research and innovation programme
 #include "../util/FluidEigenMappings.hpp"
 #include "../../data/TensorTypes.hpp"
 #include <Eigen/Core>
+#include <Eigen/Eigenvalues>
 #include <Eigen/SVD>
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <limits>
+#include <vector>
 
 namespace fluid {
 namespace algorithm {
@@ -51,6 +55,113 @@ public:
         U.block(0, 0, U.rows(), k).array().rowwise() * s.transpose();
     out <<= asFluid(result);
   }
+
+  // Landmark MDS (de Silva & Tenenbaum, 2004): classical MDS on m landmarks
+  // chosen by max-min selection, then every point is triangulated from its
+  // distances to the landmarks. Cost is O(n * m) distances and O(n + m^2)
+  // memory, instead of the O(n^2) of process()
+  void processLandmarks(RealMatrixView in, RealMatrixView out, index distance,
+                        index k, index numLandmarks)
+  {
+    using namespace Eigen;
+    using namespace _impl;
+    auto     dist = static_cast<DistanceFuncs::Distance>(distance);
+    MatrixXd input = asEigen<Matrix>(in);
+    index    n = input.rows();
+    index    m = std::min(n, std::max(numLandmarks, k + 1));
+    VectorXd sqNorms = input.rowwise().squaredNorm();
+
+    // max-min selection: each new landmark is the point furthest from all
+    // those chosen so far, which spreads landmarks over the whole data
+    std::vector<index> landmarks;
+    landmarks.reserve(asUnsigned(m));
+    MatrixXd landmarkPoints(m, input.cols());
+    VectorXd landmarkNorms(m);
+    MatrixXd landmarkDist(m, m);
+    MatrixXd column(n, 1);
+    ArrayXd  minDist = ArrayXd::Constant(n, std::numeric_limits<double>::max());
+    index    next = 0;
+    for (index j = 0; j < m; j++)
+    {
+      landmarks.push_back(next);
+      landmarkPoints.row(j) = input.row(next);
+      landmarkNorms(j) = sqNorms(next);
+      distances(input, sqNorms, landmarkPoints.row(j), landmarkNorms.segment(j, 1),
+                dist, column);
+      minDist = minDist.min(column.array());
+      for (index i = 0; i <= j; i++)
+        landmarkDist(i, j) = landmarkDist(j, i) =
+            column(landmarks[asUnsigned(i)]);
+      minDist.maxCoeff(&next);
+    }
+
+    // classical MDS on the landmarks
+    VectorXd meanDist = landmarkDist.rowwise().mean();
+    MatrixXd B = ((landmarkDist.colwise() - meanDist).rowwise() -
+                  meanDist.transpose())
+                     .array()
+                     .unaryExpr([mu = meanDist.mean()](double x) {
+                       return -0.5 * (x + mu);
+                     })
+                     .matrix();
+    SelfAdjointEigenSolver<MatrixXd> eigen(B);
+    // eigenvalues are ascending: keep the k largest, largest first
+    MatrixXd V = eigen.eigenvectors().rightCols(k).rowwise().reverse();
+    ArrayXd  lambda = eigen.eigenvalues().tail(k).reverse();
+    // triangulating with V * lambda^(-1/2) gives axes scaled by sqrt(lambda);
+    // process() scales its axes by lambda, so fold in another sqrt(lambda)
+    // to give the same map for the same data
+    ArrayXd  scale = (lambda > epsilon).cast<double>();
+    MatrixXd pseudoInverse =
+        -0.5 * (V.array().rowwise() * scale.transpose()).matrix();
+
+    // distance-based triangulation, one block of points at a time
+    FluidEigenMap<Matrix> result = asEigen<Matrix>(out);
+    constexpr index       blockSize = 1024;
+    MatrixXd              block(std::min(blockSize, n), m);
+    for (index start = 0; start < n; start += blockSize)
+    {
+      index rows = std::min(blockSize, n - start);
+      block.resize(rows, m);
+      distances(input.middleRows(start, rows), sqNorms.segment(start, rows),
+                landmarkPoints, landmarkNorms, dist, block);
+      block.rowwise() -= meanDist.transpose();
+      result.middleRows(start, rows).noalias() = block * pseudoInverse;
+    }
+  }
+
+private:
+  // pairwise distances between the rows of X and the rows of Y; the Euclidean
+  // family is expanded to ||x||^2 + ||y||^2 - 2x.y so the bulk of the work is
+  // a single matrix product
+  template <typename PointsX, typename NormsX, typename PointsY,
+            typename NormsY>
+  static void distances(const PointsX& X, const NormsX& sqNormsX,
+                        const PointsY& Y, const NormsY& sqNormsY,
+                        DistanceFuncs::Distance dist, Eigen::MatrixXd& out)
+  {
+    using namespace Eigen;
+    if (dist == DistanceFuncs::Distance::kEuclidean ||
+        dist == DistanceFuncs::Distance::kSqEuclidean)
+    {
+      out.noalias() = -2 * X * Y.transpose();
+      out.colwise() += sqNormsX;
+      out.rowwise() += sqNormsY.transpose();
+      out = out.cwiseMax(0);
+      if (dist == DistanceFuncs::Distance::kEuclidean)
+        out = out.cwiseSqrt();
+    }
+    else
+    {
+      auto& distanceFunc = DistanceFuncs::map()[dist];
+      for (index j = 0; j < Y.rows(); j++)
+      {
+        ArrayXd point = Y.row(j).transpose().array();
+        for (index i = 0; i < X.rows(); i++)
+          out(i, j) = distanceFunc(X.row(i).transpose().array(), point);
+      }
+    }
+  }
 };
 }// namespace algorithm
 }// namespace fluid
@@ -14,6 +14,7 @@ under the European Union’s Horizon 2020 research and innovation programme
 #include "../util/FluidEigenMappings.hpp"
 #include "../../data/FluidIndex.hpp"
 #include "../../data/FluidMemory.hpp"
+#include "../../data/TensorTypes.hpp"
 #include <Eigen/Core>
 #include <cassert>
 #include <cmath>
@@ -24,9 +25,14 @@ namespace algorithm {
 class MelBands
 {
 public:
+  // Filters are stored banded: each triangle only covers the bins between
+  // its neighbouring mel points, so only those weights are kept, packed
+  // band after band. Bins fall in at most two triangles, which bounds the
+  // storage at 2 * bins + bands
   MelBands(
       index maxBands, index maxFFT, Allocator& alloc = FluidDefaultAllocator())
-      : mFilters(maxBands, maxFFT / 2 + 1, alloc)
+      : mWeights(2 * (maxFFT / 2 + 1) + maxBands, alloc),
+        mStart(asUnsigned(maxBands), alloc), mLength(asUnsigned(maxBands), alloc)
   {}
 
   /*static inline double mel2hz(double x) {
@@ -45,7 +51,7 @@ public:
     using namespace Eigen;
     assert(hi > lo);
     assert(nBands > 1);
-    assert(nBins <= mFilters.cols());
+    assert(asUnsigned(nBands) <= mStart.size());
     mScale1 = 1.0 / (windowSize / 4.0); // scale to original amplitude
     index fftSize = 2 * (nBins - 1);
 
@@ -53,24 +59,29 @@ public:
     ScopedEigenMap<ArrayXd> melFreqs(nBands + 2, alloc);
     melFreqs = ArrayXd::LinSpaced(nBands + 2, hz2mel(lo), hz2mel(hi));
     melFreqs = 700.0 * ((melFreqs / 1127.01048).exp() - 1.0);
-    //    mFilters = mFiltersStorage.block(0, 0, nBands, nBins);
-    mFilters.topLeftCorner(nBands, nBins).setZero();
     ScopedEigenMap<ArrayXd> fftFreqs(nBins, alloc);
     fftFreqs = ArrayXd::LinSpaced(nBins, 0, sampleRate / 2.0);
     ScopedEigenMap<ArrayXd> melD(nBands + 1, alloc);
     melD = (melFreqs.segment(0, nBands + 1) - melFreqs.segment(1, nBands + 1))
                .abs();
-    ScopedEigenMap<ArrayXXd> ramps(melFreqs.rows(), nBins, alloc);
-    ramps = melFreqs.replicate(1, nBins);
-    ramps.rowwise() -= fftFreqs.transpose();
 
-    ScopedEigenMap<ArrayXd> lower(nBins, alloc);
-    ScopedEigenMap<ArrayXd> upper(nBins, alloc);
+    ScopedEigenMap<ArrayXd> filter(nBins, alloc);
+    index                   offset = 0;
     for (index i = 0; i < nBands; i++)
     {
-      lower = -ramps.row(i) / melD(i);
-      upper = ramps.row(i + 2) / melD(i + 1);
-      mFilters.row(i).head(nBins) = lower.min(upper).max(0);
+      filter = ((fftFreqs - melFreqs(i)) / melD(i))
+                   .min((melFreqs(i + 2) - fftFreqs) / melD(i + 1))
+                   .max(0);
+      index start = 0;
+      index end = nBins;
+      while (start < end && filter(start) == 0) start++;
+      while (end > start && filter(end - 1) == 0) end--;
+      assert(offset + end - start <= mWeights.size());
+      mWeights.segment(offset, end - start) =
+          filter.segment(start, end - start);
+      mStart[asUnsigned(i)] = start;
+      mLength[asUnsigned(i)] = end - start;
+      offset += end - start;
     }
     mNBands = nBands;
     mNBins = nBins;
@@ -88,8 +99,15 @@ public:
     double energy = frame.sum() * mScale2;
     if (usePower) frame = frame.square();
 
-    result.matrix().noalias() =
-        (mFilters.topLeftCorner(mNBands, mNBins) * frame.matrix());
+    for (index i = 0, offset = 0; i < mNBands; i++)
+    {
+      index start = mStart[asUnsigned(i)];
+      index length = mLength[asUnsigned(i)];
+      result(i, 0) = (mWeights.segment(offset, length) *
+                      frame.col(0).segment(start, length))
+                         .sum();
+      offset += length;
+    }
 
     if (magNorm) { result = result * energy / std::max(epsilon, result.sum()); }
 
@@ -100,9 +118,11 @@ public:
   double mScale2{1.0};
 
 private:
-  ScopedEigenMap<Eigen::MatrixXd> mFilters;
-  index                           mNBands;
-  index                           mNBins;
+  ScopedEigenMap<Eigen::ArrayXd> mWeights;
+  rt::vector<index>              mStart;
+  rt::vector<index>              mLength;
+  index                          mNBands;
+  index                          mNBins;
 };
 } // namespace algorithm
 } // namespace fluid
@@ -0,0 +1,152 @@
+/*
+Part of the Fluid Corpus Manipulation Project (http://www.flucoma.org/)
+Copyright 2017-2019 University of Huddersfield.
+Licensed under the BSD-3 License.
+See license.md file in the project root for full license information.
+This project has received funding from the European Research Council (ERC)
+under the European Union’s Horizon 2020 research and innovation programme
+(grant agreement No 725899).
+*/
+
+#pragma once
+
+#include "DCT.hpp"
+#include "Loudness.hpp"
+#include "MelBands.hpp"
+#include "STFT.hpp"
+#include "SpectralShape.hpp"
+#include "YINFFT.hpp"
+#include "../util/FluidEigenMappings.hpp"
+#include "../../data/FluidIndex.hpp"
+#include "../../data/FluidMemory.hpp"
+#include "../../data/FluidTensor.hpp"
+#include "../../data/TensorTypes.hpp"
+#include <Eigen/Core>
+
+namespace fluid {
+namespace algorithm {
+
+/// Computes mel bands, MFCCs, spectral shape, pitch and loudness of a window
+/// in one pass, sharing a single STFT and magnitude spectrum between them.
+/// All scratch is allocated on construction. Each frame produces a packed
+/// row laid out as
+///   [mel bands (nBands) | mfccs (nCoefs) | shape (7) | pitch, confidence |
+///    loudness, peak]
+class MultiDescriptor
+{
+public:
+  static constexpr index shapeSize = 7;
+  static constexpr index pitchSize = 2;
+  static constexpr index loudnessSize = 2;
+
+  static constexpr index size(index nBands, index nCoefs)
+  {
+    return nBands + nCoefs + shapeSize + pitchSize + loudnessSize;
+  }
+
+  MultiDescriptor(index maxFFTSize, index maxBands, index maxCoefs,
+                  Allocator& alloc = FluidDefaultAllocator())
+      : mSTFT(maxFFTSize, maxFFTSize, maxFFTSize, 0, alloc),
+        mMelBands(maxBands, maxFFTSize, alloc), mDCT(maxBands, maxCoefs, alloc),
+        mShape(alloc), mYIN(maxFFTSize / 2 + 1, alloc),
+        mLoudness(maxFFTSize, alloc),
+        mSpectrum(maxFFTSize / 2 + 1, alloc),
+        mMagnitude(maxFFTSize / 2 + 1, alloc),
+        mMelInput(maxFFTSize / 2 + 1, alloc)
+  {}
+
+  void init(index windowSize, index fftSize, index nBands, index nCoefs,
+            double sampleRate, Allocator& alloc = FluidDefaultAllocator())
+  {
+    assert(nCoefs <= nBands);
+    mSTFT.resize(windowSize, fftSize, windowSize);
+    mYIN.init(fftSize / 2 + 1);
+    mLoudness.init(windowSize, sampleRate, alloc);
+    mDCT.init(nBands, nCoefs, alloc);
+    mWindowSize = windowSize;
+    mNBins = fftSize / 2 + 1;
+    mNBands = nBands;
+    mNCoefs = nCoefs;
+    mSampleRate = sampleRate;
+    mMelLo = -1;
+    mMelHi = -1;
+    mInitialized = true;
+  }
+
+  /// minFreq and maxFreq bound the mel bands and spectral shape (maxFreq -1
+  /// meaning Nyquist); pitchMin and pitchMax bound the pitch search
+  void processFrame(const RealVectorView window, RealVectorView out,
+                    double minFreq, double maxFreq, double pitchMin,
+                    double pitchMax, bool usePower, bool weighting,
+                    bool truePeak, Allocator& alloc)
+  {
+    assert(mInitialized);
+    assert(window.size() == mWindowSize);
+    assert(out.size() == size(mNBands, mNCoefs));
+
+    // the mel filterbank only depends on the frequency range, so it is only
+    // rebuilt when that changes
+    if (minFreq != mMelLo || maxFreq != mMelHi)
+    {
+      double hi = maxFreq < 0 ? mSampleRate / 2
+                              : std::min(maxFreq, mSampleRate / 2);
+      mMelBands.init(minFreq, hi, mNBands, mNBins, mSampleRate, mWindowSize,
+                     alloc);
+      mMelLo = minFreq;
+      mMelHi = maxFreq;
+    }
+
+    auto spectrum = mSpectrum(Slice(0, mNBins));
+    auto magnitude = mMagnitude(Slice(0, mNBins));
+    auto melInput = mMelInput(Slice(0, mNBins));
+    mSTFT.processFrame(window, spectrum);
+    STFT::magnitude(spectrum, magnitude);
+
+    // MelBands works in place, so it gets a copy: squared here for power,
+    // which saves it squaring again
+    if (usePower)
+      _impl::asEigen<Eigen::Array>(melInput) =
+          _impl::asEigen<Eigen::Array>(magnitude).square();
+    else
+      melInput <<= magnitude;
+
+    index offset = 0;
+    auto  bands = out(Slice(offset, mNBands));
+    mMelBands.processFrame(melInput, bands, false, false, true, alloc);
+    offset += mNBands;
+    mDCT.processFrame(bands, out(Slice(offset, mNCoefs)));
+    offset += mNCoefs;
+    mShape.processFrame(magnitude, out(Slice(offset, shapeSize)), mSampleRate,
+                        minFreq, maxFreq, 95, false, usePower, alloc);
+    offset += shapeSize;
+    mYIN.processFrame(magnitude, out(Slice(offset, pitchSize)), pitchMin,
+                      pitchMax, mSampleRate, alloc);
+    offset += pitchSize;
+    mLoudness.processFrame(window, out(Slice(offset, loudnessSize)), weighting,
+                           truePeak, alloc);
+  }
+
+  bool initialized() const { return mInitialized; }
+
+private:
+  STFT                                 mSTFT;
+  MelBands                             mMelBands;
+  DCT                                  mDCT;
+  SpectralShape                        mShape;
+  YINFFT                               mYIN;
+  Loudness                             mLoudness;
+  FluidTensor<std::complex<double>, 1> mSpectrum;
+  FluidTensor<double, 1>               mMagnitude;
+  FluidTensor<double, 1>               mMelInput;
+  index                                mWindowSize{1024};
+  index                                mNBins{513};
+  index                                mNBands{40};
+  index                                mNCoefs{13};
+  double                               mSampleRate{44100};
+  double                               mMelLo{-1};
+  double                               mMelHi{-1};
+  bool                                 mInitialized{false};
+};
+
+} // namespace algorithm
+} // namespace fluid
@@ -40,59 +40,87 @@ public:
     asEigen<Matrix>(V).transpose().noalias() = (W1.col(idx) * H1.row(idx));
   }
 
-  // processFrame computes activations of a dictionary W in a given frame
-  void processFrame(const RealVectorView x, const RealMatrixView W0,
-                    RealVectorView out, index nIterations,
-                    RealVectorView v, Allocator& alloc)
+  NMF() : NMF(0, 0) {}
+
+  // preallocates the bases and scratch used by processFrame
+  NMF(index maxRank, index maxBins, Allocator& alloc = FluidDefaultAllocator())
+      : mW(maxBins, maxRank, alloc), mDen(maxRank, alloc), mH(maxRank, alloc),
+        mPrevH(maxRank, alloc), mHNum(maxRank, alloc), mV0(maxBins, alloc),
+        mV1(maxBins, alloc)
+  {}
+
+  // packs a dictionary (rank x bins) for processFrame, clamped, normalised and
+  // transposed, and restarts the activations
+  void init(const RealMatrixView W0)
   {
     using namespace Eigen;
     using namespace _impl;
-    index    rank = W0.extent(0);
-    FluidEigenMap<Matrix> W = asEigen<Matrix>(W0);
-    
-    ScopedEigenMap<VectorXd> h(rank, alloc);
-    h = VectorXd::Random(rank) * 0.5 + VectorXd::Constant(rank, 0.5);
-    
-    ScopedEigenMap<VectorXd> v0(x.size(), alloc);
-    v0 = asEigen<Matrix>(x);
-    W = W.array().max(epsilon).matrix();
-    h = h.array().max(epsilon).matrix();
-    v0 = v0.array().max(epsilon).matrix();
-
-//    MatrixXd WT = W.transpose();
-    ScopedEigenMap<VectorXd> norm(W.rowwise().norm(), alloc);
-    W.array().colwise() /= norm.array();
-    index nBins = x.extent(0);
-
-    ScopedEigenMap<ArrayXd> v1{nBins, alloc};
-    ScopedEigenMap<ArrayXd> vRatio{nBins, alloc};
-    ScopedEigenMap<ArrayXd> hNum{rank, alloc};
-    ScopedEigenMap<ArrayXd> hDen{rank, alloc};
-    auto ones = VectorXd::Ones(nBins);
-    while (nIterations--)
+    assert(W0.rows() <= mH.size() && W0.cols() <= mV0.size());
+    mRank = W0.rows();
+    mBins = W0.cols();
+    auto W = mW.topLeftCorner(mBins, mRank);
+    W = asEigen<Matrix>(W0).transpose().array().max(epsilon).matrix();
+    W.colwise().normalize();
+    mDen.head(mRank) = W.colwise().sum().transpose().array().max(epsilon);
+    resetActivations();
+  }
+
+  void resetActivations()
+  {
+    mH.head(mRank) = Eigen::ArrayXd::Random(mRank) * 0.5 + 0.5;
+  }
+
+  // processFrame computes activations of the packed dictionary in a given
+  // frame, starting from the previous frame's. Iteration stops early once no
+  // activation moves by more than tolerance times the largest. Returns the
+  // number of iterations run
+  index processFrame(const RealVectorView x, RealVectorView out,
+                     index maxIterations, double tolerance, RealVectorView v)
+  {
+    using namespace Eigen;
+    using namespace _impl;
+    assert(x.size() == mBins);
+    auto W = mW.topLeftCorner(mBins, mRank);
+    auto h = mH.head(mRank);
+    auto prevH = mPrevH.head(mRank);
+    auto hNum = mHNum.head(mRank);
+    auto den = mDen.head(mRank);
+    auto v0 = mV0.head(mBins);
+    auto ratio = mV1.head(mBins);
+
+    // let components that had died away come back
+    h = h.max(warmStartFloor * h.maxCoeff()).max(epsilon);
+    v0 = asEigen<Array>(x).col(0).max(epsilon);
+    index i = 0;
+    while (i < maxIterations)
     {
-      v1.matrix().noalias() = (W.transpose() * h);
-      v1 = v1.max(epsilon);
-      vRatio = v0.array() / v1;
-      hNum.matrix().noalias() = W * vRatio.matrix();
-      hDen.matrix().noalias() = W * ones;
-      h = (h.array() * hNum / hDen.max(epsilon)).matrix();
-      // VectorXd r = W * h;
-      // double divergence = (v.cwiseProduct(v.cwiseQuotient(r)) - v + r).sum();
-      // std::cout<<"Divergence "<<divergence<<std::endl;
+      prevH = h;
+      ratio.matrix().noalias() = W * h.matrix();
+      ratio = v0 / ratio.max(epsilon);
+      hNum.matrix().noalias() = W.transpose() * ratio.matrix();
+      h *= hNum / den;
+      ++i;
+      if ((h - prevH).abs().maxCoeff() <= tolerance * h.maxCoeff()) break;
     }
-    
-    if(out.data())
-      _impl::asEigen<Array>(out) =  h;
 
-    if (v.data()) _impl::asEigen<Matrix>(v).noalias() = (W.transpose() * h);
+    if (out.data()) asEigen<Array>(out).col(0) = h;
+    if (v.data()) asEigen<Matrix>(v).col(0).noalias() = W * h.matrix();
+    return i;
+  }
+
+  // spectrum of one component at the last frame's activation
+  void estimate(index idx, RealVectorView out) const
+  {
+    _impl::asEigen<Eigen::Array>(out).col(0) =
+        mW.col(idx).head(mBins).array() * mH(idx);
   }
 
   void process(const RealMatrixView X, RealMatrixView W1, RealMatrixView H1,
                RealMatrixView V1, index rank, index nIterations, bool updateW,
                bool           updateH = false,
                RealMatrixView W0 = RealMatrixView(nullptr, 0, 0, 0),
-               RealMatrixView H0 = RealMatrixView(nullptr, 0, 0, 0))
+               RealMatrixView H0 = RealMatrixView(nullptr, 0, 0, 0),
+               index beta = 1, double tolerance = 0)
   {
     using namespace Eigen;
     using namespace _impl;
@@ -123,7 +151,8 @@ public:
       H = asEigen<Matrix>(H0).transpose();
     }
     MatrixXd V = asEigen<Matrix>(X).transpose();
-    multiplicativeUpdates(V, W, H, nIterations, updateW, updateH);
+    multiplicativeUpdates(V, W, H, nIterations, updateW, updateH, beta,
+                          tolerance);
     MatrixXd VT = V.transpose();
     MatrixXd WT = W.transpose();
     MatrixXd HT = H.transpose();
@@ -141,48 +170,134 @@ public:
 private:
   using MatrixXd = Eigen::MatrixXd;
 
+  // Multiplicative updates for the beta-divergence: 0 is Itakura-Saito, 1 is
+  // Kullback-Leibler and 2 is Euclidean distance. Workspaces are allocated
+  // once per call, and KL's all-ones products are replaced by row and column
+  // sums. The GEMMs are left to Eigen, which will parallelise them if the host
+  // enables OpenMP. With a tolerance, the divergence of the model that the W
+  // update needs anyway is tracked, and iteration stops once an iteration
+  // improves it by less than that fraction
   void multiplicativeUpdates(Eigen::Ref<MatrixXd> V, Eigen::Ref<MatrixXd> W,
                              Eigen::Ref<MatrixXd> H, index nIterations,
-                             bool updateW, bool updateH)
+                             bool updateW, bool updateH, index beta,
+                             double tolerance)
   {
     using namespace Eigen;
-    MatrixXd ones = MatrixXd::Ones(V.rows(), V.cols());
+    assert(beta >= 0 && beta <= 2);
+    index    rank = W.cols();
+    bool     kl = beta == 1;
+    bool     track = tolerance > 0;
+    MatrixXd model(V.rows(), V.cols());
+    MatrixXd denRatio(kl ? 0 : V.rows(), kl ? 0 : V.cols());
+    MatrixXd wNum(updateW ? V.rows() : 0, rank);
+    MatrixXd wDen(updateW && !kl ? V.rows() : 0, rank);
+    MatrixXd hNum(updateH ? rank : 0, V.cols());
+    MatrixXd hDen(updateH && !kl ? rank : 0, V.cols());
+    ArrayXd  den(rank);
+    double   previous = 0;
     H = H.array().max(epsilon).matrix();
     W = W.array().max(epsilon).matrix();
     W.colwise().normalize();
     H.rowwise().normalize();
     for (auto i = 0; i < nIterations; ++i)
     {
+      bool haveModel = updateW || track;
+      if (haveModel) model.noalias() = W * H;
+      if (track)
+      {
+        double current = divergence(V, model, beta);
+        if (i > 0 && previous - current <= tolerance * previous) break;
+        previous = current;
+      }
       if (updateW)
       {
-        ArrayXXd V1 = (W * H).array().max(epsilon);
-        ArrayXXd wnum = ((V.array() / V1).matrix() * H.transpose()).array();
-        ArrayXXd wden = (ones * H.transpose()).array();
-        W = (W.array() * wnum / wden.max(epsilon)).matrix();
+        ratios(V, model, denRatio, beta);
+        wNum.noalias() = model * H.transpose();
+        if (kl)
+        {
+          den = H.rowwise().sum().array().max(epsilon);
+          W.array() *= wNum.array().rowwise() / den.transpose();
+        }
+        else
+        {
+          wDen.noalias() = denRatio * H.transpose();
+          W.array() *= wNum.array() / wDen.array().max(epsilon);
+        }
         if (W.maxCoeff() > epsilon) W.colwise().normalize();
         assert(W.allFinite());
+        haveModel = false;
       }
-      ArrayXXd V2 = (W * H).array().max(epsilon);
       if (updateH)
       {
-        ArrayXXd hnum = (W.transpose() * (V.array() / V2).matrix()).array();
-        ArrayXXd hden = (W.transpose() * ones).array();
-        H = (H.array() * hnum / hden.max(epsilon)).matrix();
+        if (!haveModel) model.noalias() = W * H;
+        ratios(V, model, denRatio, beta);
+        hNum.noalias() = W.transpose() * model;
+        if (kl)
+        {
+          den = W.colwise().sum().transpose().array().max(epsilon);
+          H.array() *= hNum.array().colwise() / den;
+        }
+        else
+        {
+          hDen.noalias() = W.transpose() * denRatio;
+          H.array() *= hNum.array() / hDen.array().max(epsilon);
+        }
         assert(H.allFinite());
       }
-      MatrixXd R = W * H;
-      R = R.cwiseMax(epsilon);
       for (auto& cb : mCallbacks)
         if (!cb(i + 1)) return;
-      // double divergence = (V.cwiseProduct(V.cwiseQuotient(R)) - V + R).sum();
-      // divergenceCurve.push_back(divergence);
-      // divergenceCurve(mIterations);
-      // std::cout << "Divergence " << divergence << "\n";
     }
-    V = W * H;
+    V.noalias() = W * H;
+  }
+
+  // replaces the model WH with the numerator ratio (WH)^(beta-2) V, and puts
+  // the denominator ratio (WH)^(beta-1) in den unless it is all ones (KL)
+  static void ratios(const Eigen::Ref<const MatrixXd>& V,
+                     Eigen::Ref<MatrixXd> model, Eigen::Ref<MatrixXd> den,
+                     index beta)
+  {
+    switch (beta)
+    {
+    case 0:
+      den.array() = model.array().max(epsilon).inverse();
+      model.array() = V.array() * den.array().square();
+      break;
+    case 1: model.array() = V.array() / model.array().max(epsilon); break;
+    default:
+      den = model;
+      model = V;
+    }
   }
 
-  std::vector<ProgressCallback> mCallbacks;
+  static double divergence(const Eigen::Ref<const MatrixXd>& V,
+                           const Eigen::Ref<const MatrixXd>& model, index beta)
+  {
+    auto v = V.array();
+    auto r = model.array().max(epsilon);
+    switch (beta)
+    {
+    case 0:
+    {
+      auto q = v.max(epsilon) / r;
+      return (q - q.log() - 1).sum();
+    }
+    case 1: return (v * (v.max(epsilon).log() - r.log()) - v + r).sum();
+    default: return 0.5 * (v - model.array()).square().sum();
+    }
+  }
+
+  static constexpr double warmStartFloor = 1e-3;
+
+  std::vector<ProgressCallback>  mCallbacks;
+  ScopedEigenMap<MatrixXd>       mW;
+  ScopedEigenMap<Eigen::ArrayXd> mDen;
+  ScopedEigenMap<Eigen::ArrayXd> mH;
+  ScopedEigenMap<Eigen::ArrayXd> mPrevH;
+  ScopedEigenMap<Eigen::ArrayXd> mHNum;
+  ScopedEigenMap<Eigen::ArrayXd> mV0;
+  ScopedEigenMap<Eigen::ArrayXd> mV1;
+  index                          mRank{0};
+  index                          mBins{0};
 };
 } // namespace algorithm
 } // namespace fluid
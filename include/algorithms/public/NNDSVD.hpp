@@ -15,7 +15,11 @@ under the European Union’s Horizon 2020 research and innovation programme
 #include "../../data/FluidIndex.hpp"
 #include "../../data/TensorTypes.hpp"
 #include <Eigen/Core>
-#include <Eigen/SVD>
+#include <Eigen/Eigenvalues>
+#include <Eigen/QR>
+#include <algorithm>
+#include <cmath>
+#include <random>
 
 namespace fluid {
 namespace algorithm {
@@ -25,53 +29,88 @@ class NNDSVD
 
 public:
   using MatrixXd = Eigen::MatrixXd;
+  using VectorXd = Eigen::VectorXd;
 
+  // maxFrames > 0 estimates the bases from that many evenly spaced frames;
+  // activations are still projections of every frame
   index process(RealMatrixView X, RealMatrixView W, RealMatrixView H,
                 index minRank = 0, index maxRank = 200, double amount = 0.8,
-                index method = 0) // 0 - NMF-SVD, 1 NNDSVDar, 2 NNDSVDa 3 NNDSVD
+                index method = 0, // 0 - NMF-SVD, 1 NNDSVDar, 2 NNDSVDa 3 NNDSVD
+                index maxFrames = 0)
   {
     using namespace _impl;
     using namespace Eigen;
-    MatrixXd XT = asEigen<Matrix>(X).transpose();
+    auto     XT = asEigen<Matrix>(X).transpose();
     MatrixXd WT = asEigen<Matrix>(W).transpose();
     MatrixXd HT = asEigen<Matrix>(H).transpose();
 
     assert(amount > 0 || minRank > 0);
 
-    BDCSVD<MatrixXd> svd(XT, ComputeThinV | ComputeThinU);
+    index nBins = XT.rows();
+    index nFrames = XT.cols();
+    index stride = maxFrames > 0 && maxFrames < nFrames
+                       ? (nFrames + maxFrames - 1) / maxFrames
+                       : 1;
+    index    nSubsampled = stride > 1 ? (nFrames + stride - 1) / stride : 0;
+    MatrixXd subsampled(nBins, nSubsampled);
+    for (index i = 0; i < nSubsampled; i++)
+      subsampled.col(i) = XT.col(i * stride);
 
-    MatrixXd U = svd.matrixU();
-    MatrixXd V = svd.matrixV().transpose();
-    VectorXd s = svd.singularValues();
-    MatrixXd S = svd.singularValues().asDiagonal();
-    index    k = 0;
+    MatrixXd U;
+    VectorXd s;
+    index    fixedRank = amount == 0 ? std::min(minRank, maxRank) : 0;
+    if (stride > 1)
+      leftSVD(subsampled, fixedRank, U, s);
+    else
+      leftSVD(XT, fixedRank, U, s);
+
+    index k = 0;
     if (amount == 0)
       k = minRank;
     else
     {
       double current = 0;
       double total = s.sum();
-      while ((current / total) < amount) current += s[k++];
+      while ((current / total) < amount && k < s.size()) current += s[k++];
     }
     if (k < minRank) k = minRank;
     if (k > maxRank) k = maxRank;
+    k = std::min(k, U.cols());
+
+    // S * V^T for the chosen components, over every frame
+    MatrixXd SV = U.leftCols(k).transpose() * XT;
+
+    // Components past the rank of the data have no singular value, and their
+    // vectors are arbitrary directions in its null space. They are left empty,
+    // so NMF-SVD gives zeros and the other methods fill them as they would
+    // any other zeros
+    VectorXd svNorms = SV.rowwise().norm();
+    double   rankCutoff =
+        std::sqrt(epsilon * nBins) * (k > 0 ? svNorms.maxCoeff() : 0);
+    for (index j = 0; j < k; j++)
+    {
+      if (svNorms(j) > rankCutoff) continue;
+      U.col(j).setZero();
+      SV.row(j).setZero();
+    }
 
     if (method == 0)
     {
       WT.block(0, 0, WT.rows(), k) = U.block(0, 0, U.rows(), k).array().abs();
-      HT.block(0, 0, k, HT.cols()) =
-          (S.block(0, 0, k, S.cols()) * V).array().abs();
+      HT.block(0, 0, k, HT.cols()) = SV.array().abs();
     }
     else
     {
       // avoid scaling for NMF with normalized W
+      double s0 = std::max(SV.row(0).norm(), epsilon);
       WT.col(0) = U.col(0).array().abs();
-      HT.row(0) = sqrt(s(0)) * V.row(0).array().abs();
+      HT.row(0) = sqrt(s0) * (SV.row(0) / s0).array().abs();
 
       for (index j = 1; j < k; j++)
       {
         VectorXd x = U.col(j);
-        VectorXd y = V.row(j);
+        double   sj = std::max(SV.row(j).norm(), epsilon);
+        VectorXd y = SV.row(j) / sj;
         VectorXd xP = x.array().max(0.0);
         VectorXd yP = y.array().max(0.0);
         VectorXd xN = x.array().min(0.0).abs();
@@ -79,25 +118,27 @@ public:
         double   xPNorm = xP.norm();
         double   yPNorm = yP.norm();
         double   xNNorm = xN.norm();
-        double   yNNorm = xN.norm();
+        double   yNNorm = yN.norm();
         double   mP = xPNorm * yPNorm;
         double   mN = xNNorm * yNNorm;
         ArrayXd  u;
         ArrayXd  v;
         double   sigma;
+        // an empty component, or one whose parts cancel, has both products
+        // zero; the floors keep its u and v zero rather than 0/0
         if (mP > mN)
         {
-          u = xP / xPNorm;
-          v = yP / yPNorm;
+          u = xP / std::max(xPNorm, epsilon);
+          v = yP / std::max(yPNorm, epsilon);
           sigma = mP;
         }
         else
         {
-          u = xN / xNNorm;
-          v = yN / yNNorm;
+          u = xN / std::max(xNNorm, epsilon);
+          v = yN / std::max(yNNorm, epsilon);
           sigma = mN;
         }
-        auto lbd = std::sqrt(s[j] * sigma);
+        auto lbd = std::sqrt(sj * sigma);
         WT.col(j) = u; // avoid scaling for NMF with normalized W
         HT.row(j) = lbd * v;
       }
@@ -127,6 +168,107 @@ public:
     H <<= asFluid(H1);
     return k;
   }
+
+private:
+  static constexpr index  oversampling = 10;
+  static constexpr index  maxIterations = 50;
+  static constexpr double residualTolerance = 1e-12;
+  // passes over the data the subspace iteration makes in a typical run,
+  // against the one Gram product; it is used while this many times its width
+  // is under the bins
+  static constexpr index randomizedCost = 16;
+
+  // Only the left singular vectors and values are needed, as the right ones
+  // follow by projection. A fixed rank that is small next to the number of
+  // bins uses a subspace iteration; otherwise, and for coverage, which needs
+  // every singular value, the smaller Gram matrix (bins or frames square) is
+  // diagonalised
+  template <typename Derived>
+  static void leftSVD(const Eigen::MatrixBase<Derived>& A, index fixedRank,
+                      MatrixXd& U, VectorXd& s)
+  {
+    if (fixedRank > 0 &&
+        randomizedCost * (fixedRank + oversampling) < A.rows() &&
+        truncatedSVD(A, fixedRank, U, s))
+      return;
+    gramSVD(A, U, s);
+  }
+
+  // left singular vectors and values from the eigendecomposition of the
+  // smaller of A A^T and A^T A, in descending order. From A^T A = V S^2 V^T,
+  // U = A V S^-1, with columns for zero singular values left empty
+  template <typename Derived>
+  static void gramSVD(const Eigen::MatrixBase<Derived>& A, MatrixXd& U,
+                      VectorXd& s)
+  {
+    using namespace Eigen;
+    bool     byFrames = A.cols() < A.rows();
+    index    size = byFrames ? A.cols() : A.rows();
+    MatrixXd gram = MatrixXd::Zero(size, size);
+    if (byFrames)
+      gram.selfadjointView<Lower>().rankUpdate(A.transpose());
+    else
+      gram.selfadjointView<Lower>().rankUpdate(A);
+    SelfAdjointEigenSolver<MatrixXd> eigen(gram);
+    s = eigen.eigenvalues().reverse().cwiseMax(0).cwiseSqrt();
+    if (!byFrames)
+    {
+      U = eigen.eigenvectors().rowwise().reverse();
+      return;
+    }
+    U.noalias() = A * eigen.eigenvectors().rowwise().reverse();
+    for (index j = 0; j < size; j++)
+    {
+      if (s(j) > epsilon * s(0))
+        U.col(j) /= s(j);
+      else
+        U.col(j).setZero();
+    }
+  }
+
+  // Subspace iteration (Halko, Martinsson & Tropp 2011) for the top k left
+  // singular vectors and values, from a fixed-seed start so results are
+  // repeatable. It runs until every Ritz pair's residual |AA^T u - s^2 u| is
+  // within residualTolerance of the largest s^2, which the product for the
+  // next iteration gives for free, and returns false if that takes more than
+  // maxIterations
+  template <typename Derived>
+  static bool truncatedSVD(const Eigen::MatrixBase<Derived>& A, index k,
+                           MatrixXd& U, VectorXd& s)
+  {
+    using namespace Eigen;
+    index                      l = std::min(k + oversampling, A.rows());
+    std::mt19937               rng(42);
+    std::normal_distribution<> normal;
+    MatrixXd                   Q =
+        A * MatrixXd::NullaryExpr(A.cols(), l, [&]() { return normal(rng); });
+    orthonormalize(Q);
+    for (index i = 0; i < maxIterations; i++)
+    {
+      MatrixXd Z = A.transpose() * Q;
+      SelfAdjointEigenSolver<MatrixXd> eigen(Z.transpose() * Z);
+      MatrixXd Y = eigen.eigenvectors().rowwise().reverse().leftCols(k);
+      VectorXd lambda = eigen.eigenvalues().reverse().head(k).cwiseMax(0);
+      MatrixXd AZ = A * Z;
+      MatrixXd residual = AZ * Y - Q * Y * lambda.asDiagonal();
+      if (residual.colwise().norm().maxCoeff() <=
+          residualTolerance * lambda(0))
+      {
+        U = Q * Y;
+        s = lambda.cwiseSqrt();
+        return true;
+      }
+      Q = std::move(AZ);
+      orthonormalize(Q);
+    }
+    return false;
+  }
+
+  static void orthonormalize(MatrixXd& A)
+  {
+    Eigen::HouseholderQR<MatrixXd> qr(A);
+    A = qr.householderQ() * MatrixXd::Identity(A.rows(), A.cols());
+  }
 };
 } // namespace algorithm
 } // namespace fluid
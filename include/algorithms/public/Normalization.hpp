@@ -75,27 +75,21 @@ public:
     }
   }
 
+  // maps the whole matrix and writes each element once; in and out may alias
   void process(const RealMatrixView in, RealMatrixView out,
                bool inverse = false) const
   {
     using namespace Eigen;
     using namespace _impl;
-    ArrayXXd input = asEigen<Array>(in);
-    ArrayXXd result;
-    if (!inverse)
-    {
-      result = (input.rowwise() - mDataMin.transpose());
-      result = result.rowwise() / mDataRange.transpose();
-      result = mMin + (result * mRange);
-    }
-    else
-    {
-      result = input - mMin;
-      result = result / mRange;
-      result = (result.rowwise() * mDataRange.transpose());
-      result = (result.rowwise() + mDataMin.transpose());
-    }
-    out <<= asFluid(result);
+    FluidEigenMap<Array> input = asEigen<Array>(in);
+    FluidEigenMap<Array> result = asEigen<Array>(out);
+    // fold both affine stages into one scale and offset per column
+    ArrayXd scale = inverse ? ArrayXd(mDataRange / mRange)
+                            : ArrayXd(mRange / mDataRange);
+    ArrayXd offset = inverse ? ArrayXd(mDataMin - mMin * scale)
+                             : ArrayXd(mMin - mDataMin * scale);
+    result = (input.rowwise() * scale.transpose()).rowwise() +
+             offset.transpose();
   }
 
   void setMin(double min) { 
@@ -0,0 +1,170 @@
+/*
+Part of the Fluid Corpus Manipulation Project (http://www.flucoma.org/)
+Copyright 2017-2019 University of Huddersfield.
+Licensed under the BSD-3 License.
+See license.md file in the project root for full license information.
+This project has received funding from the European Research Council (ERC)
+under the European Union’s Horizon 2020 research and innovation programme
+(grant agreement No 725899).
+*/
+
+#pragma once
+
+#include "../util/AlgorithmUtils.hpp"
+#include "../util/FluidEigenMappings.hpp"
+#include "../../data/FluidIndex.hpp"
+#include "../../data/FluidMemory.hpp"
+#include "../../data/TensorTypes.hpp"
+#include <Eigen/Core>
+#include <cassert>
+
+namespace fluid {
+namespace algorithm {
+
+/// Mini-batch KL-NMF (after Lefèvre, Bach & Févotte 2011). Each batch of
+/// frames gets its own activations, alternating with bases estimated from
+/// running sums of the multiplicative update numerators and denominators;
+/// the batch's share is added to the sums once it is done, after the past is
+/// scaled by decay. Memory depends only on the batch size
+class OnlineNMF
+{
+  using MatrixXd = Eigen::MatrixXd;
+  using VectorXd = Eigen::VectorXd;
+
+public:
+  OnlineNMF(index maxBins, index maxRank, index maxBatch,
+            Allocator& alloc = FluidDefaultAllocator())
+      : mW(maxBins, maxRank, alloc), mNum(maxBins, maxRank, alloc),
+        mDen(maxRank, alloc), mH(maxRank, maxBatch, alloc),
+        mRatio(maxBins, maxBatch, alloc), mHNum(maxRank, maxBatch, alloc),
+        mBatchNum(maxBins, maxRank, alloc), mBatchDen(maxRank, alloc),
+        mColSum(maxRank, alloc), mMaxBatch(maxBatch)
+  {}
+
+  /// random bases
+  void init(index nBins, index rank)
+  {
+    assert(nBins <= mW.rows() && rank <= mW.cols());
+    mBins = nBins;
+    mRank = rank;
+    mW.topLeftCorner(nBins, rank) = MatrixXd::Random(nBins, rank) * 0.5 +
+          MatrixXd::Constant(nBins, rank, 0.5);
+    reset();
+  }
+
+  /// seeded bases, rank x bins
+  void init(const RealMatrixView W0)
+  {
+    assert(W0.cols() <= mW.rows() && W0.rows() <= mW.cols());
+    mBins = W0.cols();
+    mRank = W0.rows();
+    mW.topLeftCorner(mBins, mRank) =
+        _impl::asEigen<Eigen::Matrix>(W0).transpose();
+    reset();
+  }
+
+  /// X is frames x bins; H receives frames x rank activations if not null
+  void processBatch(const RealMatrixView X, RealMatrixView H,
+                    index nIterations, bool updateW = true, double decay = 1)
+  {
+    using namespace Eigen;
+    using namespace _impl;
+    index n = X.rows();
+    assert(mInitialized && n <= mMaxBatch && X.cols() == mBins);
+
+    auto V = asEigen<Matrix>(X).transpose();
+    auto W = mW.topLeftCorner(mBins, mRank);
+    auto h = mH.topLeftCorner(mRank, n);
+    auto ratio = mRatio.topLeftCorner(mBins, n);
+    auto hNum = mHNum.topLeftCorner(mRank, n);
+    auto colSum = mColSum.head(mRank);
+    auto num = mNum.topLeftCorner(mBins, mRank);
+    auto den = mDen.head(mRank);
+    auto batchNum = mBatchNum.topLeftCorner(mBins, mRank);
+    auto batchDen = mBatchDen.head(mRank);
+
+    h = MatrixXd::Random(mRank, n) * 0.5 + MatrixXd::Constant(mRank, n, 0.5);
+    for (index i = 0; i < nIterations; ++i)
+    {
+      colSum = W.colwise().sum().transpose().array().max(epsilon);
+      ratio.noalias() = W * h;
+      ratio.array() = V.array() / ratio.array().max(epsilon);
+      hNum.noalias() = W.transpose() * ratio;
+      h.array() *= hNum.array().colwise() / colSum.array();
+      if (updateW)
+      {
+        // bases from the past statistics plus this batch's current estimate
+        ratio.noalias() = W * h;
+        ratio.array() = V.array() / ratio.array().max(epsilon);
+        batchNum.noalias() = ratio * h.transpose();
+        batchNum.array() *= W.array();
+        batchDen = h.rowwise().sum();
+        W.array() = (decay * num + batchNum).array().rowwise() /
+                    (decay * den + batchDen).transpose().array().max(epsilon);
+        W = W.array().max(epsilon).matrix();
+        W.colwise().normalize();
+      }
+    }
+
+    if (updateW && nIterations > 0)
+    {
+      num = decay * num + batchNum;
+      den = decay * den + batchDen;
+      // keep the statistics consistent with unit norm bases
+      W.array() = num.array().rowwise() / den.transpose().array().max(epsilon);
+      W = W.array().max(epsilon).matrix();
+      for (index k = 0; k < mRank; ++k)
+      {
+        double norm = W.col(k).norm();
+        W.col(k) /= norm;
+        num.col(k) /= norm;
+      }
+      mBatches++;
+    }
+
+    if (H.data()) asEigen<Matrix>(H) = h.transpose();
+  }
+
+  /// rank x bins
+  void getW(RealMatrixView W0) const
+  {
+    assert(W0.rows() == mRank && W0.cols() == mBins);
+    _impl::asEigen<Eigen::Matrix>(W0) =
+        mW.topLeftCorner(mBins, mRank).transpose();
+  }
+
+  index batches() const { return mBatches; }
+  index rank() const { return mRank; }
+  index bins() const { return mBins; }
+  bool  initialized() const { return mInitialized; }
+
+private:
+  void reset()
+  {
+    auto W = mW.topLeftCorner(mBins, mRank);
+    W = W.array().max(epsilon).matrix();
+    W.colwise().normalize();
+    mNum.setZero();
+    mDen.setZero();
+    mBatches = 0;
+    mInitialized = true;
+  }
+
+  ScopedEigenMap<MatrixXd> mW;
+  ScopedEigenMap<MatrixXd> mNum;
+  ScopedEigenMap<VectorXd> mDen;
+  ScopedEigenMap<MatrixXd> mH;
+  ScopedEigenMap<MatrixXd> mRatio;
+  ScopedEigenMap<MatrixXd> mHNum;
+  ScopedEigenMap<MatrixXd> mBatchNum;
+  ScopedEigenMap<VectorXd> mBatchDen;
+  ScopedEigenMap<VectorXd> mColSum;
+  index                    mMaxBatch;
+  index                    mBins{0};
+  index                    mRank{0};
+  index                    mBatches{0};
+  bool                     mInitialized{false};
+};
+
+} // namespace algorithm
+} // namespace fluid
@@ -10,6 +10,7 @@ under the European Union’s Horizon 2020 research and innovation programme
 
 #pragma once
 
+#include "../util/AlgorithmUtils.hpp"
 #include "../util/FluidEigenMappings.hpp"
 #include "../../data/TensorTypes.hpp"
 #include <Eigen/Core>
@@ -91,6 +92,9 @@ public:
     }    
   }
 
+  // Whole-matrix transform: centring and whitening are folded into a
+  // (dims x k) projection, so the data go through a single GEMM written
+  // straight into the output storage. in and out must not alias.
   double process(const RealMatrixView in, RealMatrixView out, index k,
                  bool whiten = false) const
   {
@@ -98,44 +102,41 @@ public:
     using namespace _impl;
 
     if (k > mBases.cols()) return 0;
-    MatrixXd input = asEigen<Matrix>(in);
-    MatrixXd result = (input.rowwise() - mMean.transpose()) *
-                      mBases.block(0, 0, mBases.rows(), k);
+    MatrixXd projection = mBases.leftCols(k);
     if (whiten)
-    {
-      ArrayXd norm = mExplainedVariance.segment(0, k).max(epsilon).rsqrt();
-      result = result.array().rowwise() * norm.transpose().max(epsilon);
-    }
-    double variance = 0;
+      projection *= mExplainedVariance.head(k)
+                        .max(epsilon)
+                        .rsqrt()
+                        .matrix()
+                        .asDiagonal();
+    RowVectorXd offset = mMean.transpose() * projection;
 
-    double total = mExplainedVariance.sum();
-    for (index i = 0; i < k; i++) variance += mExplainedVariance[i];
-    out <<= _impl::asFluid(result);
+    FluidEigenMap<Matrix> result = asEigen<Matrix>(out);
+    result.noalias() = asEigen<Matrix>(in) * projection;
+    result.rowwise() -= offset;
 
-    return variance / total;
+    return mExplainedVariance.head(k).sum() / mExplainedVariance.sum();
   }
 
-  void inverseProcess(RealMatrixView in, RealMatrixView out, bool whiten = false) const
+  // Whole-matrix inverse: in may have fewer columns than there are bases, in
+  // which case only the leading components are used (no zero padding needed)
+  void inverseProcess(RealMatrixView in, RealMatrixView out,
+                      bool whiten = false) const
   {
     using namespace Eigen;
+    using namespace _impl;
 
-    if (in.cols() > dims()) return;
-    if (out.cols() < in.cols()) return;
-
-    if (!whiten)
-      _impl::asEigen<Matrix>(out) =
-          (_impl::asEigen<Matrix>(in) * mBases.transpose()).rowwise() +
-          mMean.transpose();
+    if (in.cols() > size()) return;
+    if (out.cols() != dims() || out.rows() != in.rows()) return;
+    index    k = in.cols();
+    MatrixXd projection = mBases.leftCols(k).transpose();
+    if (whiten)
+      projection = mExplainedVariance.head(k).sqrt().matrix().asDiagonal() *
+                   projection;
 
-    else
-    {
-      _impl::asEigen<Matrix>(out) =
-          (_impl::asEigen<Matrix>(in) *
-           (mExplainedVariance.sqrt().matrix().asDiagonal() *
-            mBases.transpose()))
-              .rowwise() +
-          mMean.transpose();
-    }
+    FluidEigenMap<Matrix> result = asEigen<Matrix>(out);
+    result.noalias() = asEigen<Matrix>(in) * projection;
+    result.rowwise() += mMean.transpose();
   }
 
   bool  initialized() const { return mInitialized; }
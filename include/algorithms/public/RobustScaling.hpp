@@ -82,24 +82,20 @@ public:
     }
   }
 
+  // maps the whole matrix and writes each element once; in and out may alias
   void process(const RealMatrixView in, RealMatrixView out,
                bool inverse = false) const
   {
     using namespace Eigen;
     using namespace _impl;
-    ArrayXXd input = asEigen<Array>(in);
-    ArrayXXd result;
+    FluidEigenMap<Array> input = asEigen<Array>(in);
+    FluidEigenMap<Array> result = asEigen<Array>(out);
     if (!inverse)
-    {
-      result = (input.rowwise() - mMedian.transpose());
-      result = result.rowwise() / mRange.transpose();
-    }
+      result = (input.rowwise() - mMedian.transpose()).rowwise() /
+               mRange.transpose();
     else
-    {
-      result = (input.rowwise() * mRange.transpose());
-      result = (result.rowwise() + mMedian.transpose());
-    }
-    out <<= asFluid(result);
+      result = (input.rowwise() * mRange.transpose()).rowwise() +
+               mMedian.transpose();
   }
 
   void setLow(double low) { mLow = low; }
@@ -58,15 +58,13 @@ public:
     mFFT.resize(fftSize);
   }
 
-  static void magnitude(const FluidTensorView<std::complex<double>, 2> in,
-                        FluidTensorView<double, 2>                     out)
+  static void magnitude(ConstComplexMatrixView in, RealMatrixView out)
   {
     _impl::asEigen<Eigen::Array>(out) =
         _impl::asEigen<Eigen::Array>(in).abs().real();
   }
 
-  static void magnitude(const FluidTensorView<std::complex<double>, 1> in,
-                        FluidTensorView<double, 1>                     out)
+  static void magnitude(ConstComplexVectorView in, RealVectorView out)
   {
     _impl::asEigen<Eigen::Array>(out) =
         _impl::asEigen<Eigen::Array>(in).abs().real();
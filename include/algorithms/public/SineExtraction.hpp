@@ -46,8 +46,14 @@ class SineExtraction
 public:
   SineExtraction(index maxFFT, Allocator& alloc)
       : mTracking(alloc), mBuf{makeEmptyQueue(alloc)},
-        mWindowTransform(maxFFT, alloc)
-  {}
+        mWindowTransform(maxFFT, alloc), mLobe(2 * maxFFT, alloc),
+        mSlope(2 * maxFFT, alloc), mMag(maxFFT / 2 + 1, alloc),
+        mLogMag(maxFFT / 2 + 1, alloc), mFrameSines(maxFFT / 2 + 1, alloc),
+        mSineWeight(maxFFT / 2 + 1, alloc), mPeaks(alloc), mSinePeaks(alloc)
+  {
+    mPeaks.reserve(asUnsigned(maxFFT / 2 + 1));
+    mSinePeaks.reserve(asUnsigned(maxFFT / 2 + 1));
+  }
 
   void init(index windowSize, index fftSize, index transformSize,
             Allocator& alloc)
@@ -60,6 +66,7 @@ public:
     mTracking.init();
     mWindowBinIncr = mWindowTransform.size() / (mBins - 1) / 2;
     mInvWindowBinIncr = 1.0 / mWindowBinIncr;
+    computeLobeTables();
     mInitialized = true;
   }
 
@@ -72,73 +79,59 @@ public:
   {
     assert(mInitialized);
     using namespace Eigen;
-    index                    fftSize = 2 * (mBins - 1);
-    ScopedEigenMap<ArrayXcd> frame(in.size(), alloc);
-    frame = _impl::asEigen<Array>(in);
+    index fftSize = 2 * (mBins - 1);
 
     if (minTrackLength != mTracking.minTrackLength())
     {
       mBuf = makeEmptyQueue(alloc);
     }
 
-    mBuf.push(frame);
-    ScopedEigenMap<ArrayXd> mag(in.size(), alloc);
-    mag = frame.abs().real();
-    mag = mag * mScale;
-    ScopedEigenMap<ArrayXd> logMag(in.size(), alloc);
+    mBuf.emplace(in.size(), alloc);
+    auto& frame = mBuf.back();
+    frame = _impl::asEigen<Array>(in);
+    auto mag = mMag.head(mBins);
+    auto logMag = mLogMag.head(mBins);
+    mag = frame.abs().real() * mScale;
     logMag = 20 * mag.max(epsilon).log10();
 
-    vector<SinePeak> peaks(0, alloc);
-    auto tmpPeaks = mPeakDetection.process(logMag, 0, -infinity, true, false);
+    mPeaks.clear();
+    auto tmpPeaks =
+        mPeakDetection.process(logMag, 0, -infinity, true, false, alloc);
     for (auto p : tmpPeaks)
     {
       if (p.second > detectionThreshold)
       {
         double hz = sampleRate * p.first / fftSize;
-        peaks.push_back({hz, p.second, false});
+        mPeaks.push_back({hz, p.second, false});
       }
     }
 
     double maxAmp = 20 * std::log10(mag.maxCoeff());
-    mTracking.processFrame(peaks, maxAmp, minTrackLength, birthLowThreshold,
+    mTracking.processFrame(mPeaks, maxAmp, minTrackLength, birthLowThreshold,
                            birthHighThreshold, trackMethod, zetaA, zetaF, delta,
                            alloc);
-    vector<SinePeak>        sinePeaks = mTracking.getActivePeaks(alloc);
-    ScopedEigenMap<ArrayXd> frameSines(mBins, alloc);
+    mTracking.getActivePeaks(mSinePeaks);
+    auto frameSines = mFrameSines.head(mBins);
     frameSines.setZero();
-    for (auto& p : sinePeaks)
-    {
-      frameSines += synthesizePeak(p, sampleRate, bandwidth, alloc);
-    }
-    ScopedEigenMap<ArrayXXcd> result(mBins, 2, alloc);
+    for (auto& p : mSinePeaks)
+      synthesizePeak(p, sampleRate, bandwidth, frameSines);
+
+    auto result = _impl::asEigen<Array>(out);
     if (asSigned(mBuf.size()) <= mTracking.minTrackLength())
     {
-      result.col(0).setZero();
-      result.col(1).setZero();
+      result.setZero();
     }
     else
     {
       ScopedEigenMap<ArrayXcd>& resultFrame = mBuf.front();
-      ScopedEigenMap<ArrayXd>   resultMag(resultFrame.size(), alloc);
-      resultMag = resultFrame.abs().real();
-      for (index i = 0; i < mBins; i++)
-      {
-        if (frameSines(i) >= resultMag(i))
-        {
-          result(i, 0) = resultFrame(i);
-          result(i, 1) = 0;
-        }
-        else
-        {
-          double sineWeight = frameSines(i) / resultMag(i);
-          result(i, 0) = resultFrame(i) * sineWeight;
-          result(i, 1) = resultFrame(i) * (1 - sineWeight);
-        }
-      }
+      auto                      sineWeight = mSineWeight.head(mBins);
+      sineWeight = resultFrame.abs().real();
+      sineWeight = (frameSines >= sineWeight).select(1, frameSines / sineWeight);
+      result.col(0) = resultFrame * sineWeight;
+      result.col(1) = resultFrame * (1 - sineWeight);
       mBuf.pop();
     }
     mTracking.prune();
-    _impl::asEigen<Array>(out) = result;
     mCurrentFrame++;
   }
 
@@ -164,43 +157,84 @@ private:
     }
   }
 
-  double interpolateWindow(double pos)
+  // The transform is oversampled by a whole number of points per bin, so a
+  // peak reads it at one fractional offset every mWindowBinIncr points. The
+  // table and its interpolation slopes are stored split by phase, making each
+  // peak's lobe a contiguous run of both
+  void computeLobeTables()
   {
+    index size = mWindowTransform.size();
+    index incr = static_cast<index>(mWindowBinIncr);
+    mPhaseLength = (size + incr - 1) / incr;
+    assert(incr * mPhaseLength <= mLobe.size());
+    for (index r = 0; r < incr; r++)
+    {
+      for (index j = 0; j < mPhaseLength; j++)
+      {
+        index  pos = r + j * incr;
+        double y = pos < size ? mWindowTransform(pos) : 0;
+        double dY = pos + 1 < size ? mWindowTransform(pos + 1) - y : 0;
+        mLobe(r * mPhaseLength + j) = y;
+        mSlope(r * mPhaseLength + j) = mInvWindowBinIncr * dY;
+      }
+    }
+  }
+
+  // adds amp * W(pos + k * direction * incr) to bins first, first +
+  // direction, ... for n bins
+  template <typename Out>
+  void addLobe(Out& out, index first, index n, index direction, double pos,
+               double amp)
+  {
+    if (n <= 0) return;
+    index  incr = static_cast<index>(mWindowBinIncr);
     index  floor = std::lrint(std::floor(pos));
     double frac = pos - floor;
-    double dY = mWindowTransform(floor + 1) - mWindowTransform(floor);
-    return mWindowTransform(floor) + frac * mInvWindowBinIncr * dY;
+    index  start = (floor % incr) * mPhaseLength + floor / incr;
+    if (direction > 0)
+    {
+      out.segment(first, n) +=
+          amp * (mLobe.segment(start, n) + frac * mSlope.segment(start, n));
+    }
+    else
+    {
+      out.segment(first - n + 1, n).reverse() +=
+          amp * (mLobe.segment(start - n + 1, n).reverse() +
+                 frac * mSlope.segment(start - n + 1, n).reverse());
+    }
   }
 
-  ScopedEigenMap<ArrayXd> synthesizePeak(SinePeak p, double sampleRate,
-                                         index bandwidth, Allocator& alloc)
+  // accumulates the window transform of one peak over the bins within
+  // bandwidth of it
+  template <typename Out>
+  void synthesizePeak(const SinePeak& p, double sampleRate, index bandwidth,
+                      Out& out)
   {
     using namespace std;
-    index                   halfBW = bandwidth / 2;
-    ScopedEigenMap<ArrayXd> sine(mBins, alloc);
-    double                  freqBin = p.freq * 2 * (mBins - 1) / sampleRate;
+    index  halfBW = bandwidth / 2;
+    double size = static_cast<double>(mWindowTransform.size());
+    double freqBin = p.freq * 2 * (mBins - 1) / sampleRate;
     if (freqBin >= mBins - 1) freqBin = mBins - 1;
     if (freqBin < 0) freqBin = 0;
     index  freqBinFloor = lrint(floor(freqBin));
     index  freqBinCeil = freqBinFloor + 1;
     double amp = 0.5 * pow(10, p.logMag / 20);
-    double pos = mWindowTransform.size() / 2 +
-                 ((freqBinCeil - freqBin) * mWindowBinIncr);
-    for (index i = freqBinCeil; pos < mWindowTransform.size() - 2 &&
-                                i < min(freqBinCeil + halfBW, mBins - 1);
-         i++, pos += mWindowBinIncr)
-    {
-      sine[i] = amp * interpolateWindow(pos);
-    }
-    pos = (mWindowTransform.size() / 2) -
-          ((freqBin - freqBinFloor) * mWindowBinIncr);
-    for (index i = freqBinFloor;
-         pos > 1 && i > max(freqBinFloor - halfBW, asSigned(0));
-         i--, pos -= mWindowBinIncr)
-    {
-      sine[i] = amp * interpolateWindow(pos);
-    }
-    return sine;
+
+    double pos = size / 2 + ((freqBinCeil - freqBin) * mWindowBinIncr);
+    index  n = min(freqBinCeil + halfBW, mBins - 1) - freqBinCeil;
+    if (pos < size - 2)
+      n = min(n, static_cast<index>(ceil((size - 2 - pos) / mWindowBinIncr)));
+    else
+      n = 0;
+    addLobe(out, freqBinCeil, n, 1, pos, amp);
+
+    pos = size / 2 - ((freqBin - freqBinFloor) * mWindowBinIncr);
+    n = freqBinFloor - max(freqBinFloor - halfBW, asSigned(0));
+    if (pos > 1)
+      n = min(n, static_cast<index>(ceil((pos - 1) / mWindowBinIncr)));
+    else
+      n = 0;
+    addLobe(out, freqBinFloor, n, -1, pos, amp);
   }
 
   PeakDetection           mPeakDetection;
@@ -209,6 +243,15 @@ private:
   index                   mCurrentFrame{0};
   Queue                   mBuf;
   ScopedEigenMap<ArrayXd> mWindowTransform;
+  ScopedEigenMap<ArrayXd> mLobe;
+  ScopedEigenMap<ArrayXd> mSlope;
+  index                   mPhaseLength{0};
+  ScopedEigenMap<ArrayXd> mMag;
+  ScopedEigenMap<ArrayXd> mLogMag;
+  ScopedEigenMap<ArrayXd> mFrameSines;
+  ScopedEigenMap<ArrayXd> mSineWeight;
+  vector<SinePeak>        mPeaks;
+  vector<SinePeak>        mSinePeaks;
   double                  mScale{1.0};
   bool                    mInitialized{false};
   double                  mWindowBinIncr;
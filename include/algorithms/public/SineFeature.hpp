@@ -45,7 +45,7 @@ public:
     mInitialized = true;
   }
 
-  index processFrame(const ComplexVectorView in, RealVectorView freqOut,
+  index processFrame(ConstComplexVectorView in, RealVectorView freqOut,
                      RealVectorView magOut, double sampleRate,
                      double detectionThreshold, index sortBy, Allocator& alloc)
   {
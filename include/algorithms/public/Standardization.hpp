@@ -62,25 +62,20 @@ public:
     }
   }
 
+  // maps the whole matrix and writes each element once; in and out may alias
   void process(const RealMatrixView in, RealMatrixView out,
                bool inverse = false) const
   {
     using namespace Eigen;
     using namespace _impl;
-    ArrayXXd input = asEigen<Array>(in);
-    ArrayXXd result;
-
+    FluidEigenMap<Array> input = asEigen<Array>(in);
+    FluidEigenMap<Array> result = asEigen<Array>(out);
     if (!inverse)
-    {
-      result = (input.rowwise() - mMean.transpose());
-      result = result.rowwise() / mStd.transpose();
-    }
+      result = (input.rowwise() - mMean.transpose()).rowwise() /
+               mStd.transpose();
     else
-    {
-      result = (input.rowwise() * mStd.transpose());
-      result = (result.rowwise() + mMean.transpose());
-    }
-    out <<= asFluid(result);
+      result = (input.rowwise() * mStd.transpose()).rowwise() +
+               mMean.transpose();
   }
 
   bool initialized() const { return mInitialized; }
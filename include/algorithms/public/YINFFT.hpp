@@ -25,27 +25,40 @@ class YINFFT
 {
 
 public:
+  YINFFT(index maxBins, Allocator& alloc = FluidDefaultAllocator())
+      : mFFT(2 * (maxBins - 1), alloc), mSquareMag(maxBins, alloc),
+        mSquareMagSym(2 * (maxBins - 1), alloc), mYin(maxBins, alloc),
+        mMaxBins(maxBins)
+  {}
+
+  void init(index nBins)
+  {
+    assert(nBins <= mMaxBins);
+    mFFT.resize(2 * (nBins - 1));
+    mNBins = nBins;
+    mInitialized = true;
+  }
+
   void processFrame(const RealVectorView& input, RealVectorView output,
       double minFreq, double maxFreq, double sampleRate,
       Allocator& alloc = FluidDefaultAllocator())
   {
     using namespace Eigen;
-    PeakDetection pd;
-    //    ScopedEigenMap<ArrayXd>  mag = _;
-    ScopedEigenMap<ArrayXd> squareMag(input.size(), alloc);
-    squareMag = _impl::asEigen<Array>(input).square();
+    assert(mInitialized && "YINFFT: processFrame() called before init()");
+    assert(input.size() == mNBins);
+
+    index nBins = mNBins;
+    auto  squareMag = mSquareMag.head(nBins);
+    auto  squareMagSym = mSquareMagSym.head(2 * (nBins - 1));
+    auto  yin = mYin.head(nBins);
 
-    index  nBins = input.size();
-    FFT    fft(2 * (input.size() - 1));
+    squareMag = _impl::asEigen<Array>(input).col(0).square();
     double squareMagSum = 2 * squareMag.sum();
 
-    ScopedEigenMap<ArrayXd> squareMagSym(2 * (nBins - 1), alloc);
     squareMagSym << squareMag[0], squareMag.segment(1, nBins - 1),
         squareMag.segment(1, nBins - 2).reverse();
 
-    Eigen::Map<ArrayXcd>    squareMagFFT = fft.process(squareMagSym);
-    ScopedEigenMap<ArrayXd> yin(squareMagFFT.size(), alloc);
-    yin = squareMagSum - squareMagFFT.real();
+    yin = squareMagSum - mFFT.process(squareMagSym).real();
 
     if (maxFreq == 0) maxFreq = 1;
     if (minFreq == 0) minFreq = 1;
@@ -60,19 +73,19 @@ public:
     double pitchConfidence = 0;
     if (tmpSum > 0)
     {
-      ScopedEigenMap<ArrayXd> yinFlip(yin.size(), alloc);
-      yinFlip = -yin;
+      // flip in place, so peaks are minima of the yin function
+      yin = -yin;
       // segment from max to min freq
       index minBin = std::lrint(sampleRate / maxFreq);
       index maxBin = std::lrint(sampleRate / minFreq);
-      if (minBin > yinFlip.size() - 1) minBin = yinFlip.size() - 1;
-      if (maxBin > yinFlip.size() - minBin - 1)
-        maxBin = yinFlip.size() - minBin - 1;
+      if (minBin > yin.size() - 1) minBin = yin.size() - 1;
+      if (maxBin > yin.size() - minBin - 1) maxBin = yin.size() - minBin - 1;
       if (maxBin > minBin)
       {
-        //        yinFlip = yinFlip.segment(minBin, maxBin - minBin).eval();
-        auto yinSeg = yinFlip.segment(minBin, maxBin - minBin);
-        auto vec = pd.process(yinSeg, 1, yinSeg.minCoeff(), true, true, alloc);
+        auto yinSeg = yin.segment(minBin, maxBin - minBin);
+        auto vec =
+            mPeakDetection.process(yinSeg, 1, yinSeg.minCoeff(), true, true,
+                                   alloc);
         if (vec.size() > 0)
         {
           pitch = sampleRate / (minBin + vec[0].first);
@@ -83,6 +96,16 @@ public:
     output(0) = pitch;
     output(1) = pitchConfidence;
   }
+
+private:
+  FFT                            mFFT;
+  PeakDetection                  mPeakDetection;
+  ScopedEigenMap<Eigen::ArrayXd> mSquareMag;
+  ScopedEigenMap<Eigen::ArrayXd> mSquareMagSym;
+  ScopedEigenMap<Eigen::ArrayXd> mYin;
+  index                          mMaxBins;
+  index                          mNBins{0};
+  bool                           mInitialized{false};
 };
 } // namespace algorithm
 } // namespace fluid
@@ -0,0 +1,109 @@
+/*
+Part of the Fluid Corpus Manipulation Project (http://www.flucoma.org/)
+Copyright 2017-2019 University of Huddersfield.
+Licensed under the BSD-3 License.
+See license.md file in the project root for full license information.
+This project has received funding from the European Research Council (ERC)
+under the European Union’s Horizon 2020 research and innovation programme
+(grant agreement No 725899).
+*/
+
+#pragma once
+
+#include "FluidEigenMappings.hpp"
+#include "../../data/FluidIndex.hpp"
+#include "../../data/FluidMemory.hpp"
+#include "../../data/FluidTensor.hpp"
+#include <Eigen/Core>
+#include <array>
+#include <cassert>
+
+namespace fluid {
+namespace algorithm {
+
+/// Cascade of biquad sections in transposed direct form II, filtering up to
+/// maxChannels channels with independent state. Multichannel blocks are
+/// frames x channels, so each frame is contiguous and every section step is
+/// vectorised across channels. All processing is in place
+template <index Sections>
+class BiquadCascade
+{
+  using ArrayXd = Eigen::ArrayXd;
+  using ArrayXXd = Eigen::ArrayXXd;
+
+public:
+  BiquadCascade(
+      index maxChannels = 1, Allocator& alloc = FluidDefaultAllocator())
+      : mState(maxChannels, 2 * Sections, alloc), mOutput(maxChannels, alloc)
+  {
+    mState.setZero();
+  }
+
+  /// normalised coefficients, i.e. a0 = 1
+  void setSection(index i, double b0, double b1, double b2, double a1,
+                  double a2)
+  {
+    assert(i < Sections);
+    mCoeffs[asUnsigned(i)] = {b0, b1, b2, a1, a2};
+  }
+
+  void reset() { mState.setZero(); }
+
+  index maxChannels() const { return mState.rows(); }
+
+  /// single sample on channel 0
+  double processSample(double x)
+  {
+    for (index k = 0; k < Sections; k++)
+    {
+      auto&   c = mCoeffs[asUnsigned(k)];
+      double& s1 = mState(0, 2 * k);
+      double& s2 = mState(0, 2 * k + 1);
+      double  y = c[0] * x + s1;
+      s1 = c[1] * x - c[3] * y + s2;
+      s2 = c[2] * x - c[4] * y;
+      x = y;
+    }
+    return x;
+  }
+
+  /// one block on channel 0
+  void process(FluidTensorView<double, 1> io)
+  {
+    for (index i = 0; i < io.size(); i++) io(i) = processSample(io(i));
+  }
+
+  /// frames x channels block, one filter state per channel
+  void process(FluidTensorView<double, 2> io)
+  {
+    index channels = io.cols();
+    assert(channels <= maxChannels());
+    assert(io.descriptor().strides[1] == 1 && "channels must be contiguous");
+    index stride = io.descriptor().strides[0];
+    auto  y = mOutput.head(channels);
+    for (index i = 0; i < io.rows(); i++)
+    {
+      Eigen::Map<ArrayXd> x(io.data() + i * stride, channels);
+      for (index k = 0; k < Sections; k++)
+      {
+        auto& c = mCoeffs[asUnsigned(k)];
+        auto  s1 = mState.col(2 * k).head(channels);
+        auto  s2 = mState.col(2 * k + 1).head(channels);
+        y = c[0] * x + s1;
+        s1 = c[1] * x - c[3] * y + s2;
+        s2 = c[2] * x - c[4] * y;
+        x = y;
+      }
+    }
+  }
+
+private:
+  using Coefficients = std::array<double, 5>; // b0, b1, b2, a1, a2
+
+  std::array<Coefficients, static_cast<size_t>(Sections)> mCoeffs{};
+  ScopedEigenMap<ArrayXXd>                                mState;
+  ScopedEigenMap<ArrayXd>                                 mOutput;
+};
+
+} // namespace algorithm
+} // namespace fluid
@@ -11,6 +11,9 @@ under the European Union’s Horizon 2020 research and innovation programme
 #pragma once
 
 #include "AlgorithmUtils.hpp"
+#include "BiquadCascade.hpp"
+#include "../../data/FluidMemory.hpp"
+#include "../../data/FluidTensor.hpp"
 #include <cassert>
 #include <cmath>
 
@@ -20,38 +23,31 @@ namespace algorithm {
 class ButterworthHPFilter
 {
 public:
+  ButterworthHPFilter(
+      index maxChannels = 1, Allocator& alloc = FluidDefaultAllocator())
+      : mFilter(maxChannels, alloc)
+  {}
+
   void init(double cutoff)
   { // as fraction of sample rate
     using namespace std;
     double c = tan(pi * cutoff);
-    mB0 = 1.0 / (1.0 + sqrtTwo * c + pow(c, 2.0));
-    mB1 = -2.0 * mB0;
-    mB2 = mB0;
-    mA0 = 2.0 * mB0 * (pow(c, 2.0) - 1.0);
-    mA1 = mB0 * (1.0 - sqrtTwo * c + pow(c, 2.0));
-    mXnz1 = 0;
-    mXnz2 = 0;
-    mYnz1 = 0;
-    mYnz2 = 0;
+    double b0 = 1.0 / (1.0 + sqrtTwo * c + pow(c, 2.0));
+    mFilter.setSection(0, b0, -2.0 * b0, b0, 2.0 * b0 * (pow(c, 2.0) - 1.0),
+                       b0 * (1.0 - sqrtTwo * c + pow(c, 2.0)));
+    mFilter.reset();
   }
 
-  double processSample(double x)
-  {
-    double y = mB0 * x + mB1 * mXnz1 + mB2 * mXnz2 - mA0 * mYnz1 - mA1 * mYnz2;
-    mXnz2 = mXnz1;
-    mXnz1 = x;
-    mYnz2 = mYnz1;
-    mYnz1 = y;
-    return y;
-  }
+  double processSample(double x) { return mFilter.processSample(x); }
+
+  /// filter a block in place
+  void process(FluidTensorView<double, 1> io) { mFilter.process(io); }
+
+  /// filter a frames x channels block in place
+  void process(FluidTensorView<double, 2> io) { mFilter.process(io); }
 
 private:
-  double mB0{0.0}, mB1{0.0}, mB2{0.0};
-  double mA0{0.0}, mA1{0.0};
-  double mXnz1{0.0};
-  double mXnz2{0.0};
-  double mYnz1{0.0};
-  double mYnz2{0.0};
+  BiquadCascade<1> mFilter;
 };
 } // namespace algorithm
 } // namespace fluid
@@ -62,6 +62,9 @@ class FFT
 public:
   using MapXcd = Eigen::Map<Eigen::ArrayXcd>;
 
+  // the largest size the shared setup has tables for
+  static constexpr index maxFFTSize = 65536;
+
   static void setup() { getFFTSetup(); }
 
   FFT() = delete;
@@ -110,7 +113,7 @@ public:
 protected:
   static FFT_SETUP_D getFFTSetup()
   {
-    static const impl::FFTSetup static_setup(65536);
+    static const impl::FFTSetup static_setup(maxFFTSize);
     return static_setup();
   }
 
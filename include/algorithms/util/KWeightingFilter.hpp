@@ -11,15 +11,25 @@ under the European Union’s Horizon 2020 research and innovation programme
 #pragma once
 
 #include "AlgorithmUtils.hpp"
+#include "BiquadCascade.hpp"
 #include "../../data/FluidIndex.hpp"
+#include "../../data/FluidMemory.hpp"
+#include "../../data/FluidTensor.hpp"
 #include <cmath>
 
 namespace fluid {
 namespace algorithm {
 
+/// BS.1770 K-weighting: a high shelf followed by a high pass, run as a
+/// biquad cascade on up to maxChannels channels
 class KWeightingFilter
 {
 public:
+  KWeightingFilter(
+      index maxChannels = 1, Allocator& alloc = FluidDefaultAllocator())
+      : mFilter(maxChannels, alloc)
+  {}
+
   void init(double sampleRate)
   {
     // from https://github.com/jiixyj/libebur128/blob/master/ebur128/ebur128.c
@@ -56,43 +66,22 @@ public:
     hiA[1] = 2.0 * (K * K - 1.0) / (1.0 + K / Q + K * K);
     hiA[2] = (1.0 - K / Q + K * K) / (1.0 + K / Q + K * K);
 
-    // Combined
-    mB[0] = shelvB[0] * hiB[0];
-    mB[1] = shelvB[0] * hiB[1] + shelvB[1] * hiB[0];
-    mB[2] = shelvB[0] * hiB[2] + shelvB[1] * hiB[1] + shelvB[2] * hiB[0];
-    mB[3] = shelvB[1] * hiB[2] + shelvB[2] * hiB[1];
-    mB[4] = shelvB[2] * hiB[2];
-
-    mA[0] = shelvA[0] * hiA[0];
-    mA[1] = shelvA[0] * hiA[1] + shelvA[1] * hiA[0];
-    mA[2] = shelvA[0] * hiA[2] + shelvA[1] * hiA[1] + shelvA[2] * hiA[0];
-    mA[3] = shelvA[1] * hiA[2] + shelvA[2] * hiA[1];
-    mA[4] = shelvA[2] * hiA[2];
-    for (index i = 0; i < 5; i++)
-    {
-      mX[i] = 0;
-      mY[i] = 0;
-    }
+    mFilter.setSection(0, shelvB[0], shelvB[1], shelvB[2], shelvA[1],
+                       shelvA[2]);
+    mFilter.setSection(1, hiB[0], hiB[1], hiB[2], hiA[1], hiA[2]);
+    mFilter.reset();
   }
 
-  double processSample(double x)
-  {
-    double y = 0;
-    mX[0] = x;
-    for (index i = 1; i < 5; i++) y -= mA[i] * mY[i - 1];
-    for (index i = 0; i < 5; i++) y += mB[i] * mX[i];
-
-    for (index i = 4; i > 0; i--)
-    {
-      mX[i] = mX[i - 1];
-      mY[i] = mY[i - 1];
-    }
-    mY[0] = y;
-    return y;
-  }
+  double processSample(double x) { return mFilter.processSample(x); }
+
+  /// filter a block in place
+  void process(FluidTensorView<double, 1> io) { mFilter.process(io); }
+
+  /// filter a frames x channels block in place
+  void process(FluidTensorView<double, 2> io) { mFilter.process(io); }
 
 private:
-  double mA[5], mB[5], mX[5], mY[5];
+  BiquadCascade<2> mFilter;
 };
 
 } // namespace algorithm
@@ -13,21 +13,28 @@ under the European Union’s Horizon 2020 research and innovation programme
 #include "../../data/FluidIndex.hpp"
 #include "../../data/FluidMemory.hpp"
 #include "../../data/FluidTensor.hpp"
+#include <algorithm>
 #include <cassert>
-#include <deque>
 
 namespace fluid {
 namespace algorithm {
 
+/// Sliding median over the last size() samples. The window is held in a ring
+/// and split across two heaps: a max-heap of the lower (size + 1) / 2 values
+/// and a min-heap of the rest, so the median is always the top of the lower
+/// heap. Each new sample overwrites the oldest one in place and is sifted back
+/// into position, which makes every update O(log size) with no allocation.
 class MedianFilter
 {
 
 public:
   MedianFilter(index maxSize, Allocator& alloc)
-      : mUnsorted(alloc), mSorted(alloc)
+      : mValues(alloc), mPositions(alloc), mLow(alloc), mHigh(alloc)
   {
-    mUnsorted.reserve(asUnsigned(maxSize));
-    mSorted.reserve(asUnsigned(maxSize));
+    mValues.reserve(asUnsigned(maxSize));
+    mPositions.reserve(asUnsigned(maxSize));
+    mLow.reserve(asUnsigned(maxSize));
+    mHigh.reserve(asUnsigned(maxSize));
     init(maxSize);
   }
 
@@ -35,36 +42,143 @@ public:
   {
     assert(size >= 3);
     assert(size % 2);
-    assert(asUnsigned(size) <= mUnsorted.capacity());
-    mFilterSize = asUnsigned(size);
-    mUnsorted.resize(mFilterSize, 0);
-    mSorted.resize(mFilterSize, 0);
-    std::fill(mUnsorted.begin(), mUnsorted.end(), 0);
-    std::fill(mSorted.begin(), mSorted.end(), 0);
+    assert(asUnsigned(size) <= mValues.capacity());
+    mFilterSize = size;
+    mHead = 0;
+    mValues.resize(asUnsigned(size));
+    mPositions.resize(asUnsigned(size));
+    mLow.resize(asUnsigned((size + 1) / 2));
+    mHigh.resize(asUnsigned(size / 2));
+    std::fill(mValues.begin(), mValues.end(), 0);
+    // all values are equal, so any assignment of slots to heaps is valid
+    for (index i = 0; i < size; i++)
+    {
+      index low = asSigned(mLow.size());
+      if (i < low)
+      {
+        mLow[asUnsigned(i)] = i;
+        mPositions[asUnsigned(i)] = i;
+      }
+      else
+      {
+        mHigh[asUnsigned(i - low)] = i;
+        mPositions[asUnsigned(i)] = -(i - low) - 1;
+      }
+    }
     mInitialized = true;
   }
 
   double processSample(double val)
   {
     assert(mInitialized);
-    double old = mUnsorted.front();
-    std::rotate(mUnsorted.begin(), mUnsorted.begin() + 1, mUnsorted.end());
-    mUnsorted[mFilterSize - 1] = val;
-    mSorted.erase(std::lower_bound(mSorted.begin(), mSorted.end(), old));
-    mSorted.insert(std::upper_bound(mSorted.begin(), mSorted.end(), val), val);
-    return mSorted[size_t(mSorted.size() / 2)];
+    index slot = mHead;
+    mHead = mHead + 1 == mFilterSize ? 0 : mHead + 1;
+    mValues[asUnsigned(slot)] = val;
+    index pos = mPositions[asUnsigned(slot)];
+    if (pos >= 0)
+      sift<true>(mLow, pos);
+    else
+      sift<false>(mHigh, -pos - 1);
+    // only the replaced value can have crossed the boundary between heaps
+    if (value(mLow[0]) > value(mHigh[0]))
+    {
+      std::swap(mLow[0], mHigh[0]);
+      mPositions[asUnsigned(mLow[0])] = 0;
+      mPositions[asUnsigned(mHigh[0])] = -1;
+      siftDown<true>(mLow, 0);
+      siftDown<false>(mHigh, 0);
+    }
+    return value(mLow[0]);
   }
 
-  index size() { return asSigned(mFilterSize); }
+  /// Filter a whole vector in one pass, treating samples beyond either end of
+  /// `in` as zero: out(i) is the median of in over the window ending at
+  /// i + lookahead. A lookahead of size() / 2 centres the window, size() - 1
+  /// gives the window starting at i. Overwrites the running state.
+  void process(FluidTensorView<const double, 1> in,
+               FluidTensorView<double, 1> out, index lookahead)
+  {
+    assert(mInitialized);
+    assert(in.size() == out.size());
+    assert(lookahead >= 0 && lookahead < mFilterSize);
+    index n = in.size();
+    auto  sample = [&in, n](index i) { return i >= 0 && i < n ? in(i) : 0.0; };
+    // the first size() - 1 samples replace the whole window, so it needn't be
+    // reset before use
+    for (index i = lookahead - mFilterSize + 1; i < lookahead; i++)
+      processSample(sample(i));
+    for (index i = 0; i < n; i++) out(i) = processSample(sample(i + lookahead));
+  }
+
+  index size() { return mFilterSize; }
 
   bool initialized() { return mInitialized; }
 
 private:
-  std::size_t mFilterSize{0};
-  bool        mInitialized{false};
+  double value(index slot) const { return mValues[asUnsigned(slot)]; }
+
+  // true if slot a belongs above slot b in the given heap
+  template <bool isMax>
+  bool above(index a, index b) const
+  {
+    return isMax ? value(a) > value(b) : value(a) < value(b);
+  }
+
+  template <bool isMax>
+  void place(rt::vector<index>& heap, index pos, index slot)
+  {
+    heap[asUnsigned(pos)] = slot;
+    mPositions[asUnsigned(slot)] = isMax ? pos : -pos - 1;
+  }
+
+  template <bool isMax>
+  void sift(rt::vector<index>& heap, index pos)
+  {
+    if (!siftUp<isMax>(heap, pos)) siftDown<isMax>(heap, pos);
+  }
+
+  template <bool isMax>
+  bool siftUp(rt::vector<index>& heap, index pos)
+  {
+    index slot = heap[asUnsigned(pos)];
+    index start = pos;
+    while (pos > 0)
+    {
+      index parent = (pos - 1) / 2;
+      if (!above<isMax>(slot, heap[asUnsigned(parent)])) break;
+      place<isMax>(heap, pos, heap[asUnsigned(parent)]);
+      pos = parent;
+    }
+    place<isMax>(heap, pos, slot);
+    return pos != start;
+  }
+
+  template <bool isMax>
+  void siftDown(rt::vector<index>& heap, index pos)
+  {
+    index slot = heap[asUnsigned(pos)];
+    index n = asSigned(heap.size());
+    while (2 * pos + 1 < n)
+    {
+      index child = 2 * pos + 1;
+      if (child + 1 < n &&
+          above<isMax>(heap[asUnsigned(child + 1)], heap[asUnsigned(child)]))
+        child++;
+      if (!above<isMax>(heap[asUnsigned(child)], slot)) break;
+      place<isMax>(heap, pos, heap[asUnsigned(child)]);
+      pos = child;
+    }
+    place<isMax>(heap, pos, slot);
+  }
+
+  index mFilterSize{0};
+  index mHead{0};
+  bool  mInitialized{false};
 
-  rt::vector<double> mUnsorted;
-  rt::vector<double> mSorted;
+  rt::vector<double> mValues;    // ring buffer of the window
+  rt::vector<index>  mPositions; // heap position of each slot, high heap < 0
+  rt::vector<index>  mLow;       // max-heap of slots in the lower half
+  rt::vector<index>  mHigh;      // min-heap of slots in the upper half
 };
 
 } // namespace algorithm
@@ -16,6 +16,8 @@ under the European Union’s Horizon 2020 research and innovation programme
 #include "../../data/FluidIndex.hpp"
 #include "../../data/FluidMemory.hpp"
 #include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
 
 namespace fluid {
 namespace algorithm {
@@ -31,8 +33,8 @@ public:
   using VectorXd = Eigen::VectorXd;
 
   Novelty(index maxSize, index maxDims, Allocator& alloc)
-      : mKernel{maxSize, maxSize, alloc},
-        mSimilarity{maxSize, maxSize, alloc}, mBufer{maxSize, maxDims, alloc}
+      : mKernel{maxSize, alloc}, mSimilarity{maxSize, maxSize, alloc},
+        mBufer{maxSize, maxDims, alloc}, mRowNorms{maxSize, alloc}
   {}
 
   void init(index kernelSize, index nDims, Allocator& alloc)
@@ -43,41 +45,44 @@ public:
     createKernel(alloc);
     mSimilarity.setZero();
     mBufer.setZero();
+    mRowNorms.setConstant(epsilon);
+    mHead = 0;
     mInitialized = true;
   }
 
+  // The history and similarity matrix are circular: the newest frame
+  // overwrites the oldest slot, so each frame only computes one new row (and
+  // column) of similarities. Because the checkerboard kernel is the outer
+  // product of a signed Gaussian with itself, its correlation with the
+  // similarity matrix is the quadratic form w' S w, with w permuted into slot
+  // order.
   template<typename EigenThing>
   double processFrame(const EigenThing& input, Allocator& alloc)
   {
     assert(mInitialized);
-    mBufer.block(0, 0, mKernelSize - 1, mNDims) =
-        mBufer.block(1, 0, mKernelSize - 1, mNDims);
-    ScopedEigenMap<ArrayXXd> x(1, mNDims, alloc);
-    x = mBufer.block(mKernelSize - 1, 0, 1, mNDims);
-    ScopedEigenMap<VectorXd> in1(input.size(), alloc);
-    in1 = input.matrix();
-    mBufer.block(mKernelSize - 1, 0, 1, mNDims) = in1.transpose();
-    ScopedEigenMap<VectorXd> tmp(mKernelSize, alloc);
-    tmp.noalias() = mBufer.topLeftCorner(mKernelSize, mNDims) * input.matrix();
-    ScopedEigenMap<VectorXd> norm(mKernelSize, alloc);
-    norm.noalias() = mBufer.topLeftCorner(mKernelSize, mNDims)
-                         .rowwise()
-                         .norm()
-                         .cwiseMax(epsilon) *
-                     input.matrix().norm();
-    norm = norm.cwiseMax(epsilon);
-    tmp = (tmp.array() / norm.array()).matrix();
-    mSimilarity.block(0, 0, mKernelSize - 1, mKernelSize - 1) =
-        mSimilarity.block(1, 1, mKernelSize - 1, mKernelSize - 1);
-    ScopedEigenMap<ArrayXXd> x1(mKernelSize, 1, alloc);
-    x1 = mSimilarity.block(0, mKernelSize - 1, mKernelSize, 1);
-    mSimilarity.block(0, mKernelSize - 1, mKernelSize, 1) = tmp;
-    mSimilarity.block(mKernelSize - 1, 0, 1, mKernelSize) = tmp.transpose();
-    double result =
-        (mSimilarity.topLeftCorner(mKernelSize, mKernelSize).array() *
-         mKernel.topLeftCorner(mKernelSize, mKernelSize))
-            .sum();
-    return result / mNorm;
+    index slot = mHead;
+    mHead = mHead + 1 == mKernelSize ? 0 : mHead + 1;
+    double inputNorm = input.matrix().norm();
+    mBufer.row(slot).head(mNDims) = input.matrix().transpose();
+    mRowNorms(slot) = std::max(inputNorm, epsilon);
+
+    auto history = mBufer.topLeftCorner(mKernelSize, mNDims);
+    ScopedEigenMap<VectorXd> similarity(mKernelSize, alloc);
+    similarity.noalias() = history * input.matrix();
+    similarity.array() /=
+        (mRowNorms.head(mKernelSize) * inputNorm).max(epsilon);
+    mSimilarity.block(0, slot, mKernelSize, 1) = similarity;
+    mSimilarity.block(slot, 0, 1, mKernelSize) = similarity.transpose();
+
+    // the oldest frame, in slot mHead, takes the first kernel weight
+    ScopedEigenMap<VectorXd> weights(mKernelSize, alloc);
+    index                    wrap = mKernelSize - mHead;
+    weights.tail(wrap) = mKernel.head(wrap).matrix();
+    weights.head(mHead) = mKernel.segment(wrap, mHead).matrix();
+    ScopedEigenMap<VectorXd> weighted(mKernelSize, alloc);
+    weighted.noalias() =
+        mSimilarity.topLeftCorner(mKernelSize, mKernelSize) * weights;
+    return weights.dot(weighted) / mNorm;
   }
 
 private:
@@ -87,20 +92,21 @@ private:
     ScopedEigenMap<ArrayXd> gaussian(mKernelSize, alloc);
     WindowFuncs::map()[WindowFuncs::WindowTypes::kGaussian](mKernelSize,
                                                             gaussian);
-    ScopedEigenMap<MatrixXd> tmp(mKernelSize, mKernelSize, alloc);
-    tmp.noalias() = gaussian.matrix() * gaussian.matrix().transpose();
-    tmp.block(h, 0, h + 1, h) *= -1;
-    tmp.block(0, h, h, h + 1) *= -1;
-    mKernel.topLeftCorner(mKernelSize, mKernelSize) = tmp.array();
-    mNorm = mKernel.topLeftCorner(mKernelSize, mKernelSize).square().sum();
+    // Foote's kernel is w w' with w the Gaussian negated from the centre on
+    auto kernel = mKernel.head(mKernelSize);
+    kernel = gaussian;
+    kernel.tail(h + 1) *= -1;
+    mNorm = std::pow(kernel.square().sum(), 2);
   }
 
   bool                     mInitialized{false};
   index                    mKernelSize{3};
   index                    mNDims{513};
-  ScopedEigenMap<ArrayXXd> mKernel;
+  index                    mHead{0};
+  ScopedEigenMap<ArrayXd>  mKernel;
   ScopedEigenMap<MatrixXd> mSimilarity;
   ScopedEigenMap<MatrixXd> mBufer;
+  ScopedEigenMap<ArrayXd>  mRowNorms;
   double                   mNorm{1.};
 };
 } // namespace algorithm
@@ -116,11 +116,11 @@ public:
   }
 
 
-  vector<SinePeak> getActivePeaks(Allocator& alloc)
+  void getActivePeaks(vector<SinePeak>& sinePeaks)
   {
-    vector<SinePeak> sinePeaks(0, alloc);
-    index            latencyFrame = mCurrentFrame - mMinTrackLength;
-    if (latencyFrame < 0) return sinePeaks;
+    sinePeaks.clear();
+    index latencyFrame = mCurrentFrame - mMinTrackLength;
+    if (latencyFrame < 0) return;
     for (auto&& track : mTracks)
     {
       if (track.startFrame > latencyFrame) continue;
@@ -131,7 +131,6 @@ public:
       sinePeaks.push_back(
           track.peaks[asUnsigned(latencyFrame - track.startFrame)]);
     }
-    return sinePeaks;
   }
 
 private:
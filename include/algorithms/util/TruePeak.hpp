@@ -24,23 +24,21 @@ namespace algorithm {
 
 namespace impl {
 // Based on https://github.com/jiixyj/libebur128/blob/master/ebur128/ebur128.c
+// Polyphase FIR: row f of mCoeffs holds the taps of output phase f by delay,
+// so each input sample produces all phases with one dense matrix-vector
+// product. The delay line is stored twice over, newest sample first, so the
+// last `latency` inputs are always one contiguous segment
 class Interpolator
 {
-
-  struct filter
-  {
-    unsigned int  count; /* Number of coefficients in this subfilter */
-    unsigned int* index; /* Delay index of corresponding filter coeff */
-    double*       coeff; /* List of subfilter coefficients */
-  };
+  using MatrixXd = Eigen::MatrixXd;
+  using VectorXd = Eigen::VectorXd;
 
 public:
   Interpolator(index maxtaps, index maxfactor, Allocator& alloc)
       : mMaxTaps{maxtaps}, mMaxFactor{maxfactor},
-        mMaxLatency{(mMaxTaps + mMaxFactor - 1) / mMaxFactor},
-        mBuffer(asUnsigned(mMaxLatency), alloc), mCount(asUnsigned(mMaxFactor), alloc),
-        mFilters(mMaxFactor, mMaxLatency, alloc),
-        mIndex(mMaxFactor, mMaxLatency, alloc)
+        mMaxLatency{mMaxTaps},
+        mDelay(2 * mMaxLatency, alloc), mCoeffs(mMaxFactor, mMaxLatency, alloc),
+        mPhases(mMaxFactor, alloc)
   {}
 
   void init(index taps, index factor)
@@ -56,11 +54,8 @@ public:
 
     constexpr double almostZero = 1e-6;
     mHead = 0;
-    std::fill(mBuffer.begin(), mBuffer.end(), 0.0);
-    std::fill(mCount.begin(), mCount.end(), 0);
-
-    mIndex.fill(0);
-    mFilters.fill(0);
+    mDelay.setZero();
+    mCoeffs.setZero();
 
     for (index i = 0; i < taps; ++i)
     {
@@ -73,13 +68,7 @@ public:
       }
       c *= 0.5 * (1 - cos(twoPi * i / (taps - 1)));
 
-      if (std::abs(c) > almostZero)
-      {
-        index f = i % factor;
-        index t = mCount[asUnsigned(f)]++;
-        mFilters(f, t) = c;
-        mIndex(f, t) = i / factor;
-      }
+      if (std::abs(c) > almostZero) { mCoeffs(i % factor, i / factor) = c; }
     }
 
     mInitialized = true;
@@ -92,31 +81,56 @@ public:
     assert(in.size());
     assert(out.size() >= mFactor * in.size());
 
-    auto outP = out.begin();
-
-    for (auto& x : in)
+    for (index i = 0; i < in.size(); ++i)
     {
+      push(in(i));
+      for (index f = 0; f < mFactor; ++f) out(i * mFactor + f) = mPhases(f);
+    }
+  }
 
-      mBuffer[asUnsigned(mHead)] = x;
-      for (index i = 0; i < mFactor; ++i)
-      {
-        double acc = 0;
-        for (index j = 0, count = mCount[asUnsigned(i)]; j < count; ++j)
-        {
-          index offset = mHead - mIndex(i, j);
-          if (offset < 0) { offset += mLatency; }
-          double c = mFilters(i, j);
-          acc += mBuffer[asUnsigned(offset)] * c;
-        }
-        *outP = acc;
-        std::advance(outP, 1);
-      }
-      mHead++;
-      if (mHead == mLatency) { mHead = 0; }
+  /// Oversample a block, returning only the largest absolute output value
+  double processMax(FluidTensorView<const double, 1> in)
+  {
+    assert(mInitialized);
+    double peak = 0;
+    for (index i = 0; i < in.size(); ++i)
+    {
+      push(in(i));
+      peak = std::max(peak, mPhases.head(mFactor).cwiseAbs().maxCoeff());
     }
+    return peak;
   }
 
 private:
+  void push(double x)
+  {
+    mHead = mHead == 0 ? mLatency - 1 : mHead - 1;
+    mDelay(mHead) = x;
+    mDelay(mHead + mLatency) = x;
+    switch (mFactor)
+    {
+    case 2: filter<2>(); break;
+    case 4: filter<4>(); break;
+    default:
+      mPhases.head(mFactor).noalias() =
+          mCoeffs.topLeftCorner(mFactor, mLatency) *
+          mDelay.segment(mHead, mLatency).matrix();
+    }
+  }
+
+  // the factors TruePeak uses get a fixed-size accumulator, which keeps all
+  // phases in one SIMD register
+  template <int Factor>
+  void filter()
+  {
+    using Phases = Eigen::Matrix<double, Factor, 1>;
+    Phases acc = Phases::Zero();
+    for (index d = 0; d < mLatency; ++d)
+      acc += Eigen::Map<const Phases>(mCoeffs.col(d).data()) *
+             mDelay(mHead + d);
+    mPhases.template head<Factor>() = acc;
+  }
+
   bool mInitialized{false};
 
   index mMaxTaps;
@@ -127,11 +141,10 @@ private:
   index mFactor;
   index mLatency;
 
-  rt::vector<double>     mBuffer;
-  rt::vector<index>      mCount;
-  FluidTensor<double, 2> mFilters;
-  FluidTensor<index, 2>  mIndex;
-  index                  mHead;
+  ScopedEigenMap<Eigen::ArrayXd> mDelay;
+  ScopedEigenMap<MatrixXd>       mCoeffs;
+  ScopedEigenMap<VectorXd>       mPhases;
+  index                          mHead;
 };
 
 
@@ -144,9 +157,8 @@ class TruePeak
   static constexpr index maxFactor = 4;
 
 public:
-  TruePeak(index maxSize, Allocator& alloc)
-      : mInterpolator(nTaps, maxFactor, alloc), mBuffer{maxFactor * maxSize,
-                                                        alloc}
+  TruePeak(index /*maxSize*/, Allocator& alloc)
+      : mInterpolator(nTaps, maxFactor, alloc)
   {}
 
   void init(index /*size*/, double sampleRate, Allocator&)
@@ -160,27 +172,20 @@ public:
   {
     using namespace Eigen;
 
-    index outSize = input.size() * mFactor;
-    assert(outSize <= mBuffer.size());
-
     if (mSampleRate >= (4 * 44100))
     {
       return _impl::asEigen<Array>(input).abs().maxCoeff();
     }
     else
     {
-      auto output = mBuffer(Slice(0, outSize));
-      output.fill(0);
-      mInterpolator.processFrame(input, output);
-      return _impl::asEigen<Array>(output).abs().maxCoeff();
+      return mInterpolator.processMax(input);
     }
   }
 
 private:
-  impl::Interpolator     mInterpolator;
-  double                 mSampleRate{44100.0};
-  index                  mFactor{4};
-  FluidTensor<double, 1> mBuffer;
+  impl::Interpolator mInterpolator;
+  double             mSampleRate{44100.0};
+  index              mFactor{4};
 };
 } // namespace algorithm
 } // namespace fluid
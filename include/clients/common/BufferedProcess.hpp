@@ -20,7 +20,9 @@ under the European Union’s Horizon 2020 research and innovation programme
 #include "../../data/FluidMemory.hpp"
 #include "../../data/FluidTensor.hpp"
 #include "../../data/TensorTypes.hpp"
+#include <algorithm>
 #include <memory>
+#include <mutex>
 
 namespace fluid {
 namespace client {
@@ -166,6 +168,148 @@ private:
   rt::vector<double>  mFrameOut;
 };
 
+/// A single STFT analysis of one signal, shared by every client that reads
+/// it with the same FFT settings. The first subscriber to ask for a new host
+/// block runs the analysis; the others get the stored spectra for that block,
+/// as read-only views. A block is recognised as already analysed by
+/// comparing the input with a copy of the last one, so a subscriber that was
+/// skipped just triggers a fresh analysis. Subscribers must run on the same
+/// audio thread. Stages are only made by SharedSTFTRegistry
+class SharedSTFT
+{
+public:
+  /// Per-subscriber record of the last block it was given
+  struct Subscription
+  {
+    index generation{-1};
+  };
+
+  SharedSTFT(const void* key, FFTParams p, index channels, index hostSize,
+             Allocator& alloc)
+      : mKey(key), mWinSize(p.winSize()), mHopSize(p.hopSize()),
+        mFFTSize(p.fftSize()), mChannels(channels), mHostSize(hostSize),
+        mBufferedProcess(p.winSize(), 0, channels, 0, hostSize, alloc),
+        mSTFT(p.winSize(), p.fftSize(), p.hopSize(), 0, alloc),
+        mFrames(asUnsigned(maxFrames() * channels * p.frameSize()), alloc),
+        mLastInput(asUnsigned(channels * hostSize), alloc)
+  {}
+
+  bool matches(const void* key, FFTParams p, index channels,
+               index hostSize) const
+  {
+    return key == mKey && p.winSize() == mWinSize &&
+           p.hopSize() == mHopSize && p.fftSize() == mFFTSize &&
+           channels == mChannels && hostSize == mHostSize;
+  }
+
+  template <typename T, typename F>
+  void processInput(const std::vector<HostVector<T>>& input,
+                    Subscription& s, FluidContext& c, F&& processFunc)
+  {
+    if (s.generation == mGeneration || !sameAsLast(input)) analyse(input, c);
+    s.generation = mGeneration;
+    index frameSize = mFFTSize / 2 + 1;
+    for (index i = 0; i < mNumFrames; ++i)
+      processFunc(ConstComplexMatrixView{
+          mFrames.data(), i * mChannels * frameSize, mChannels, frameSize});
+  }
+
+private:
+  index maxFrames() const { return mHostSize / mHopSize + 1; }
+
+  template <typename T>
+  bool sameAsLast(const std::vector<HostVector<T>>& input) const
+  {
+    if (mGeneration < 0 || input[0].size() != mHostSize) return false;
+    for (index i = 0; i < mChannels; ++i)
+    {
+      auto          in = input[asUnsigned(i)];
+      const double* last = mLastInput.data() + i * mHostSize;
+      for (index j = 0; j < mHostSize; ++j)
+        if (static_cast<double>(in(j)) != last[j]) return false;
+    }
+    return true;
+  }
+
+  template <typename T>
+  void analyse(const std::vector<HostVector<T>>& input, FluidContext& c)
+  {
+    index frameSize = mFFTSize / 2 + 1;
+    mBufferedProcess.push(input);
+    mNumFrames = 0;
+    mBufferedProcess.processInput(
+        mWinSize, mHopSize, c, [this, frameSize](RealMatrixView in) {
+          assert(mNumFrames < maxFrames());
+          ComplexMatrixView frame{mFrames.data(),
+                                  mNumFrames++ * mChannels * frameSize,
+                                  mChannels, frameSize};
+          for (index i = 0; i < mChannels; ++i)
+            mSTFT.processFrame(in.row(i), frame.row(i));
+        });
+    index n = std::min(input[0].size(), mHostSize);
+    for (index i = 0; i < mChannels; ++i)
+    {
+      auto    in = input[asUnsigned(i)];
+      double* last = mLastInput.data() + i * mHostSize;
+      for (index j = 0; j < n; ++j) last[j] = static_cast<double>(in(j));
+    }
+    ++mGeneration;
+  }
+
+  const void*                      mKey;
+  index                            mWinSize;
+  index                            mHopSize;
+  index                            mFFTSize;
+  index                            mChannels;
+  index                            mHostSize;
+  index                            mGeneration{-1};
+  index                            mNumFrames{0};
+  BufferedProcess                  mBufferedProcess;
+  algorithm::STFT                  mSTFT;
+  rt::vector<std::complex<double>> mFrames;
+  rt::vector<double>               mLastInput;
+};
+
+/// Host-side owner of shared analyses. A host that knows several clients
+/// read the same signal makes one of these with its allocator, and puts it
+/// in the FluidContext along with a key for the signal. Clients look up or
+/// create their stage here when they are reset, off the audio thread, so the
+/// audio thread never locks, allocates or frees a stage
+class SharedSTFTRegistry
+{
+public:
+  SharedSTFTRegistry(Allocator& alloc) : mAlloc(alloc), mStages(alloc) {}
+
+  SharedSTFTRegistry(const SharedSTFTRegistry&) = delete;
+  SharedSTFTRegistry& operator=(const SharedSTFTRegistry&) = delete;
+
+  /// Find or create the analysis for signal `key` with these settings. Takes
+  /// a lock and may allocate, so never call it from the audio thread
+  std::shared_ptr<SharedSTFT> acquire(const void* key, FFTParams p,
+                                      index channels, index hostSize)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    // stages nobody subscribes to any more; dropping them here means a
+    // stage is only ever freed on this thread
+    mStages.erase(std::remove_if(mStages.begin(), mStages.end(),
+                                 [](const std::shared_ptr<SharedSTFT>& s) {
+                                   return s.use_count() == 1;
+                                 }),
+                  mStages.end());
+    for (auto& stage : mStages)
+      if (stage->matches(key, p, channels, hostSize)) return stage;
+    mStages.push_back(std::allocate_shared<SharedSTFT>(
+        foonathan::memory::std_allocator<SharedSTFT, Allocator>(mAlloc), key,
+        p, channels, hostSize, mAlloc));
+    return mStages.back();
+  }
+
+private:
+  Allocator&                              mAlloc;
+  std::mutex                              mMutex;
+  rt::vector<std::shared_ptr<SharedSTFT>> mStages;
+};
+
 template <bool Normalise = true>
 class STFTBufferedProcess
 {
@@ -250,6 +394,16 @@ public:
     index     chansIn = mBufferedProcess.channelsIn();
     FFTParams fftParams = setup(p);
 
+    // the stage was picked in reset(); if the settings have changed since,
+    // analyse privately until the next reset
+    if (mShared && mShared->matches(c.analysisKey(), fftParams, chansIn,
+                                    mBufferedProcess.hostSize()))
+    {
+      mShared->processInput(input, mSubscription, c,
+                            std::forward<F>(processFunc));
+      return;
+    }
+
     mBufferedProcess.push(input);
     ComplexMatrixView spectrumIn{
         mSpectrumIn.data(), 0, chansIn, fftParams.frameSize()};
@@ -306,7 +460,24 @@ public:
     }
   }
 
-  void reset() { mBufferedProcess.reset(); }
+  void reset()
+  {
+    mBufferedProcess.reset();
+    mSubscription = {};
+  }
+
+  /// As reset(), and (re)subscribes to the shared analysis named in the
+  /// context, if any, for these settings. This can lock and allocate, so
+  /// hosts must call it outside the audio callback
+  void reset(const FluidContext& c, FFTParams p)
+  {
+    reset();
+    mShared = nullptr;
+    if (c.analysisRegistry() && c.analysisKey())
+      mShared = c.analysisRegistry()->acquire(c.analysisKey(), p,
+                                              mBufferedProcess.channelsIn(),
+                                              mBufferedProcess.hostSize());
+  }
 
 private:
   FFTParams setup(FFTParams fftParams)
@@ -333,6 +504,8 @@ private:
   rt::vector<double>                         mFrameAndWindow;
   algorithm::STFT                            mSTFT;
   algorithm::ISTFT                           mISTFT;
+  std::shared_ptr<SharedSTFT>                mShared;
+  SharedSTFT::Subscription                   mSubscription;
 };
 
 } // namespace client
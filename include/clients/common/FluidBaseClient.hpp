@@ -16,10 +16,13 @@ under the European Union’s Horizon 2020 research and innovation programme
 #include "ParameterConstraints.hpp"
 #include "ParameterSet.hpp"
 #include "ParameterTypes.hpp"
+#include "ParameterUpdateQueue.hpp"
 #include "Result.hpp"
 #include "TupleUtilities.hpp"
 #include "../../data/FluidIndex.hpp"
 #include "../../data/FluidMeta.hpp"
+#include <atomic>
+#include <memory>
 #include <tuple>
 
 namespace fluid {
@@ -195,9 +198,13 @@ public:
     return mClient.template process<T>(c);
   }
 
+  /// Real-time entry point. Parameter changes queued with queue() are
+  /// applied here, as one snapshot at the block boundary
   template <typename Input, typename Output>
   void process(Input& input, Output& output, FluidContext& c)
   {
+    if (auto updates = mUpdates.load(std::memory_order_acquire))
+      updates->apply(mParams.get());
     mClient.process(input, output, c);
   }
 
@@ -216,6 +223,23 @@ public:
     mParams.template set(std::forward<T>(x), reportage);
   }
 
+  /// Lock-free alternative to setting parameters directly while audio is
+  /// running, for the host's message thread. Returns false, dropping the
+  /// change, if the queue is full. The queue is allocated by the first call,
+  /// so wrappers that never queue don't carry it
+  template <size_t N, typename T>
+  bool queue(T&& x)
+  {
+    auto updates = mUpdates.load(std::memory_order_relaxed);
+    if (!updates)
+    {
+      mUpdateQueue = std::make_unique<UpdateQueue>();
+      updates = mUpdateQueue.get();
+      mUpdates.store(updates, std::memory_order_release);
+    }
+    return updates->template push<N>(std::forward<T>(x));
+  }
+
   auto latency() { return mClient.latency(); }
 
   index audioChannelsIn() const noexcept { return mClient.audioChannelsIn(); }
@@ -265,9 +289,14 @@ public:
   }
 
 private:
+  using UpdateQueue = ParameterUpdateQueue<ParamDescType>;
+
   std::reference_wrapper<ParamSetViewType> mParams;
 
   Client mClient;
+  // not carried across moves: a wrapper is only moved before it runs
+  std::unique_ptr<UpdateQueue> mUpdateQueue;
+  std::atomic<UpdateQueue*>    mUpdates{nullptr};
 };
 
 
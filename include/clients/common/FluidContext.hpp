@@ -20,6 +20,8 @@ namespace fluid {
 namespace client {
 
 
+class SharedSTFTRegistry;
+
 class FluidContext
 {
 public:
@@ -43,9 +45,22 @@ public:
   }
   
   void hostVectorSize(index vs) { mVectorSize = vs; };
-  
+
+  /// Identifies the signal feeding a client, and the host's registry of
+  /// shared analyses. STFT clients reset with the same registry, key and FFT
+  /// settings share one analysis (see SharedSTFTRegistry)
+  const void*         analysisKey() const noexcept { return mAnalysisKey; }
+  SharedSTFTRegistry* analysisRegistry() const noexcept { return mRegistry; }
+  void analysisKey(const void* key, SharedSTFTRegistry* registry)
+  {
+    mAnalysisKey = key;
+    mRegistry = registry;
+  }
+
 private:  
   FluidTask*  mTask{nullptr};
+  const void*         mAnalysisKey{nullptr};
+  SharedSTFTRegistry* mRegistry{nullptr};
   index mVectorSize{0};
   Allocator*  mAllocator{nullptr};
   MessageList mMessages;
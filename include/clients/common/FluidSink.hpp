@@ -12,16 +12,17 @@ under the European Union’s Horizon 2020 research and innovation programme
 #include "../../data/FluidIndex.hpp"
 #include "../../data/FluidMemory.hpp"
 #include "../../data/FluidTensor.hpp"
+#include "RingBufferUtils.hpp"
+#include <algorithm>
 #include <cassert>
-#include <functional>
 
 namespace fluid {
 
-/// An output buffer, with overlap-add
+/// An output buffer, with overlap-add. As with FluidSource, storage is padded
+/// to a power of two so that ring positions wrap with a mask.
 template <typename T>
 class FluidSink
 {
-//  using Container = rt::vector<T>;
   using Matrix = FluidTensor<T, 2>;
   using View = FluidTensorView<T, 2>;
   using const_view_type = const FluidTensorView<T, 2>;
@@ -38,7 +39,8 @@ public:
             Allocator& alloc = FluidDefaultAllocator())
       : mSize(size), mChannels(channels), mHostBufferSize(maxHostVectorSize),
         mMaxHostBufferSize(maxHostVectorSize),
-        matrix(channels, bufferSize(), alloc)
+        mMask(impl::ringSize(size + maxHostVectorSize) - 1),
+        matrix(channels, mMask + 1, alloc)
   {}
 
   /// Accumulate data into the buffer, optionally moving
@@ -55,36 +57,40 @@ public:
 
     assert(blocksize <= bufferSize());
 
-    index offset = frameTime;
+    if (frameTime + blocksize > bufferSize()) { return; }
 
-    if (offset + blocksize > bufferSize()) { return; }
+    index offset = (mCounter + frameTime) & mMask;
+    index size = std::min(blocksize, mMask + 1 - offset);
 
-    offset += mCounter;
-    offset = offset < bufferSize() ? offset : offset - bufferSize();
-
-    index size = ((offset + blocksize) > bufferSize()) ? bufferSize() - offset
-                                                       : blocksize;
-
-    addIn(x(Slice(0), Slice(0, size)), offset, size);
-    addIn(x(Slice(0), Slice(size, blocksize - size)), 0, blocksize - size);
+    for (index i = 0; i < mChannels; ++i)
+    {
+      T*   row = matrix.row(i).data();
+      auto in = x.row(i);
+      impl::addBlock<T>(in(Slice(0, size)), row + offset);
+      impl::addBlock<T>(in(Slice(size, blocksize - size)), row);
+    }
   }
 
   /// Copy data from the buffer, and zero where it was
   template <typename U>
   void pull(FluidTensorView<U, 2> out)
   {
+    assert(out.rows() == mChannels);
     index blocksize = out.cols();
     if (blocksize > bufferSize()) { return; }
-    doPull(out, blocksize);
+    for (index i = 0; i < mChannels; ++i) outAndZero(out.row(i), i, blocksize);
+    mCounter = (mCounter + blocksize) & mMask;
   }
 
   template <typename U>
   void pull(const std::vector<FluidTensorView<U, 1>>& out)
   {
-    assert(out.size() == mChannels);
+    assert(out.size() == asUnsigned(mChannels));
     index blocksize = out[0].size();
     if (blocksize > bufferSize()) return;
-    doPull(out, blocksize);
+    for (index i = 0; i < mChannels; ++i)
+      outAndZero(out[asUnsigned(i)], i, blocksize);
+    mCounter = (mCounter + blocksize) & mMask;
   }
 
   /// Reset the buffer, resizing if the host buffer size
@@ -106,59 +112,15 @@ public:
   index hostBufferSize() const noexcept { return mHostBufferSize; }
 
 private:
-  void addIn(const_view_type in, index offset, index size)
-  {
-    if (size)
-    {
-      matrix(Slice(0), Slice(offset, size)).apply(in, [](T& x, T y) {
-        x += y;
-      });
-    }
-  }
-
   template <typename U>
-  void doPull(U& container, index blocksize)
+  void outAndZero(FluidTensorView<U, 1> out, index channel, index blocksize)
   {
-    index offset = mCounter;
-    index size =
-        offset + blocksize > bufferSize() ? bufferSize() - offset : blocksize;
-    index overspill = blocksize - size;
-
-    fillContainer(container, offset, size, overspill);
-  }
-
-  template <typename U>
-  void fillContainer(FluidTensorView<U, 2> out, index offset, index size,
-                     index overspill)
-  {
-    outAndZero(out(Slice(0), Slice(0, size)), offset, size, Slice(0));
-    outAndZero(out(Slice(0), Slice(size, overspill)), 0, overspill, Slice(0));
-  }
-
-  template <typename U>
-  void fillContainer(std::vector<FluidTensorView<U, 1>>& out, index offset,
-                     index size, index overspill)
-  {
-    for (index i = 0; i < mChannels; ++i)
-      outAndZero(FluidTensorView<U, 2>(out[0](Slice(0, size))), offset, size, i,
-                 i == mChannels - 1);
-    for (index i = 0; i < mChannels; ++i)
-      outAndZero(FluidTensorView<U, 2>(out[0](Slice(size, overspill))), 0,
-                 overspill, i, i == mChannels - 1);
-  }
-
-  template <typename U, typename Chans>
-  void outAndZero(FluidTensorView<U, 2> out, index offset, index size,
-                  Chans chans, bool incrementTime = true)
-  {
-    if (size)
-    {
-      View buf = matrix(chans, Slice(offset, size));
-      View output = buf;
-      out <<= output;
-      buf.fill(0);
-      if (incrementTime) mCounter = offset + size;
-    }
+    T*    row = matrix.row(channel).data();
+    index size = std::min(blocksize, mMask + 1 - mCounter);
+    impl::copyBlock(row + mCounter, out(Slice(0, size)));
+    impl::copyBlock(row, out(Slice(size, blocksize - size)));
+    std::fill_n(row + mCounter, size, 0);
+    std::fill_n(row, blocksize - size, 0);
   }
 
   index bufferSize() const { return mSize + mHostBufferSize; }
@@ -168,6 +130,7 @@ private:
   index     mCounter = 0;
   index     mHostBufferSize = 0;
   index     mMaxHostBufferSize = 0;
-  Matrix      matrix;
+  index     mMask;
+  Matrix    matrix;
 };
 } // namespace fluid
@@ -13,18 +13,21 @@ under the European Union’s Horizon 2020 research and innovation programme
 #include "../../data/FluidIndex.hpp"
 #include "../../data/FluidMemory.hpp"
 #include "../../data/FluidTensor.hpp"
+#include "RingBufferUtils.hpp"
+#include <algorithm>
 #include <cassert>
 
 namespace fluid {
 
-/// Input buffer, with possibly overlapped reads
+/// Input buffer, with possibly overlapped reads. Storage is padded to a power
+/// of two so that ring positions wrap with a mask, and each channel is copied
+/// as at most two contiguous blocks.
 template <typename T>
 class FluidSource
 {
   using Matrix = FluidTensor<T, 2>;
   using View = FluidTensorView<T, 2>;
-
-//  using Container = rt::vector<T>;
+  using ConstView = FluidTensorView<const T, 2>;
 
 public:
   FluidSource(const FluidSource&) = delete;
@@ -36,7 +39,8 @@ public:
               Allocator& alloc = FluidDefaultAllocator())
       : mSize(size), mChannels(channels), mHostBufferSize(maxHostBufferSize),
         mMaxHostBufferSize(maxHostBufferSize),
-        matrix(channels, bufferSize(), alloc)
+        mMask(impl::ringSize(size + maxHostBufferSize) - 1),
+        matrix(channels, mMask + 1, alloc)
   {}
 
   FluidSource() : FluidSource(0, 1, 0, FluidDefaultAllocator()){};
@@ -50,7 +54,10 @@ public:
 
     assert(in.size() == asUnsigned(mChannels));
     index blocksize = in[0].size();
-    doPush(in, blocksize);
+    assert(blocksize <= bufferSize());
+    for (index i = 0; i < mChannels; ++i)
+      copyIn(in[asUnsigned(i)], i, blocksize);
+    mCounter = (mCounter + blocksize) & mMask;
   }
 
   template <typename U>
@@ -61,7 +68,9 @@ public:
 
     assert(in.rows() == mChannels);
     index blocksize = in.cols();
-    doPush(in, blocksize);
+    assert(blocksize <= bufferSize());
+    for (index i = 0; i < mChannels; ++i) copyIn(in.row(i), i, blocksize);
+    mCounter = (mCounter + blocksize) & mMask;
   }
 
   /// Pull a frame of data out of the buffer.
@@ -76,16 +85,32 @@ public:
       return;
     }
 
-    offset += blocksize;
-    offset = (offset <= mCounter) ? mCounter - offset
-                                  : mCounter + bufferSize() - offset;
+    index start = (mCounter - offset - blocksize) & mMask;
+    index size = std::min(blocksize, mMask + 1 - start);
 
-    index size =
-        (offset + blocksize > bufferSize()) ? bufferSize() - offset : blocksize;
+    for (index i = 0; i < mChannels; ++i)
+    {
+      const T* row = matrix.row(i).data();
+      auto     outRow = out.row(i);
+      impl::copyBlock(row + start, outRow(Slice(0, size)));
+      impl::copyBlock(row, outRow(Slice(size, blocksize - size)));
+    }
+  }
 
-    out(Slice(0), Slice(0, size)) <<= matrix(Slice(0), Slice(offset, size));
-    out(Slice(0), Slice(size, blocksize - size)) <<=
-        matrix(Slice(0), Slice(0, blocksize - size));
+  /// Pull a frame without copying when it is contiguous in the buffer.
+  /// Otherwise the frame is copied into `scratch`, which is returned. The
+  /// returned view is only valid until the next push().
+  ConstView pullView(View scratch, index frameTime)
+  {
+    index blocksize = scratch.cols();
+    index offset = mHostBufferSize - frameTime;
+    index start = (mCounter - offset - blocksize) & mMask;
+
+    if (offset <= bufferSize() && start + blocksize <= mMask + 1)
+      return matrix(Slice(0), Slice(start, blocksize));
+
+    pull(scratch, frameTime);
+    return scratch;
   }
 
   void setHostBufferSize(const index size)
@@ -110,48 +135,13 @@ public:
 private:
   index bufferSize() const { return mSize + mHostBufferSize; }
 
-
   template <typename U>
-  void doPush(U& in, index blocksize)
+  void copyIn(FluidTensorView<U, 1> in, index channel, index blocksize)
   {
-    assert(blocksize <= bufferSize());
-    index offset = mCounter;
-    index size = ((offset + blocksize) > bufferSize()) ? bufferSize() - offset
-                                                       : blocksize;
-    index overspill = blocksize - size;
-    copyContainer(in, offset, size, overspill);
-  }
-
-  template <typename U>
-  void copyContainer(FluidTensorView<U, 2> x, index offset, index size,
-                     index overspill)
-  {
-    // Copy all channels (rows)
-    copyIn(x(Slice(0), Slice(0, size)), offset, size, Slice(0));
-    copyIn(x(Slice(0), Slice(size, overspill)), 0, overspill, Slice(0));
-  }
-
-  template <typename U>
-  void copyContainer(const std::vector<FluidTensorView<U, 1>>& x, index offset,
-                     index size, index overspill)
-  {
-    for (index i = 0; i < mChannels; ++i)
-      copyIn(FluidTensorView<U, 2>(x[asUnsigned(i)](Slice(0, size))), offset,
-             size, i, i == mChannels - 1);
-    for (index i = 0; i < mChannels; ++i)
-      copyIn(FluidTensorView<U, 2>(x[asUnsigned(i)](Slice(size, overspill))), 0,
-             overspill, i, i == mChannels - 1);
-  }
-
-  template <typename U, typename Chans>
-  void copyIn(FluidTensorView<U, 2> input, index offset, index size,
-              Chans chans, bool incrementTime = true)
-  {
-    if (size)
-    {
-      matrix(chans, Slice(offset, size)) <<= input;
-      if (incrementTime) mCounter = offset + size;
-    }
+    T*    row = matrix.row(channel).data();
+    index size = std::min(blocksize, mMask + 1 - mCounter);
+    impl::copyBlock(in(Slice(0, size)), row + mCounter);
+    impl::copyBlock(in(Slice(size, blocksize - size)), row);
   }
 
   index     mCounter = 0;
@@ -159,6 +149,7 @@ private:
   index     mChannels;
   index     mHostBufferSize = 0;
   index     mMaxHostBufferSize = 0;
+  index     mMask;
   Matrix    matrix;
 };
 } // namespace fluid
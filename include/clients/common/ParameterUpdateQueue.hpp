@@ -0,0 +1,146 @@
+/*
+Part of the Fluid Corpus Manipulation Project (http://www.flucoma.org/)
+Copyright 2017-2019 University of Huddersfield.
+Licensed under the BSD-3 License.
+See license.md file in the project root for full license information.
+This project has received funding from the European Research Council (ERC)
+under the European Union’s Horizon 2020 research and innovation programme
+(grant agreement No 725899).
+*/
+
+#pragma once
+
+#include "ParameterSet.hpp"
+#include "Result.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <new>
+#include <type_traits>
+
+namespace fluid {
+namespace client {
+
+/// Lock-free single-producer / single-consumer queue of parameter changes.
+/// The host's message thread push()es new values as they arrive, through
+/// ClientWrapper::queue(), and ClientWrapper's real-time process() calls
+/// apply() at the start of each block. So a client never sees a parameter
+/// change part way through processing, and neither side blocks or
+/// allocates once the wrapper has created its queue on the first queue(). Only parameters with trivially copyable values (floats,
+/// longs, enums, choices) can be queued; buffers, strings and FFT settings
+/// keep using ParameterSet directly.
+template <typename ParamDescType, size_t Capacity = 256>
+class ParameterUpdateQueue
+{
+  using DescriptorSetType = std::remove_const_t<ParamDescType>;
+  using IndexList = typename DescriptorSetType::IndexList;
+  static constexpr size_t NumParams = IndexList::size();
+
+  template <size_t N>
+  using ValueType = typename DescriptorSetType::template ParamType<N>::type;
+
+  template <size_t N>
+  static constexpr bool isQueueable()
+  {
+    return std::is_trivially_copyable<ValueType<N>>::value;
+  }
+
+  template <size_t... Is>
+  static constexpr size_t maxValueSize(std::index_sequence<Is...>)
+  {
+    return std::max({size_t(1),
+                     (isQueueable<Is>() ? sizeof(ValueType<Is>) : 1)...});
+  }
+
+  static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0,
+                "Queue capacity must be a power of two");
+
+  struct Entry
+  {
+    size_t param;
+    alignas(std::max_align_t) unsigned char value[maxValueSize(IndexList())];
+  };
+
+public:
+  ParameterUpdateQueue() = default;
+  ParameterUpdateQueue(const ParameterUpdateQueue&) = delete;
+  ParameterUpdateQueue& operator=(const ParameterUpdateQueue&) = delete;
+
+  /// Producer side. Returns false, dropping the change, if the queue is full
+  template <size_t N>
+  bool push(ValueType<N> x) noexcept
+  {
+    static_assert(isQueueable<N>(),
+                  "Only trivially copyable parameters can be queued");
+    size_t tail = mTail.load(std::memory_order_relaxed);
+    size_t next = (tail + 1) & (Capacity - 1);
+    if (next == mHead.load(std::memory_order_acquire)) return false;
+    mEntries[tail].param = N;
+    new (mEntries[tail].value) ValueType<N>(x);
+    mTail.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /// Consumer side: apply everything queued so far to `params`, then
+  /// re-apply constraints. Repeated changes to a parameter are coalesced so
+  /// only the newest is set. Returns false if there was nothing to apply
+  template <typename ParamSetType>
+  bool apply(ParamSetType& params,
+             std::array<Result, NumParams>* results = nullptr)
+  {
+    size_t head = mHead.load(std::memory_order_relaxed);
+    size_t tail = mTail.load(std::memory_order_acquire);
+    if (head == tail) return false;
+
+    std::bitset<NumParams> seen;
+    for (size_t i = tail; i != head;)
+    {
+      i = (i - 1) & (Capacity - 1);
+      const Entry& e = mEntries[i];
+      if (seen[e.param]) continue;
+      seen.set(e.param);
+      dispatch(params, e, IndexList());
+    }
+    mHead.store(tail, std::memory_order_release);
+    params.constrainParameterValuesRT(results);
+    return true;
+  }
+
+  bool empty() const noexcept
+  {
+    return mHead.load(std::memory_order_acquire) ==
+           mTail.load(std::memory_order_acquire);
+  }
+
+private:
+  template <typename ParamSetType, size_t... Is>
+  static void dispatch(ParamSetType& params, const Entry& e,
+                       std::index_sequence<Is...>)
+  {
+    (void) std::initializer_list<int>{
+        (e.param == Is ? (set<Is>(params, e), 0) : 0)...};
+  }
+
+  template <size_t N, typename ParamSetType>
+  static void set(ParamSetType& params, const Entry& e)
+  {
+    if constexpr (isQueueable<N>())
+    {
+      ValueType<N> x =
+          *std::launder(reinterpret_cast<const ValueType<N>*>(e.value));
+      params.template set<N>(std::move(x), nullptr);
+    }
+  }
+
+  // head and tail a cache line apart, so producer and consumer don't contend.
+  // Padded rather than over-aligned so the queue can live anywhere operator
+  // new puts it
+  std::atomic<size_t>         mHead{0};
+  char                        mPad[64 - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t>         mTail{0};
+  std::array<Entry, Capacity> mEntries;
+};
+
+} // namespace client
+} // namespace fluid
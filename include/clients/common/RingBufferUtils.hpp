@@ -0,0 +1,77 @@
+/*
+Part of the Fluid Corpus Manipulation Project (http://www.flucoma.org/)
+Copyright 2017-2019 University of Huddersfield.
+Licensed under the BSD-3 License.
+See license.md file in the project root for full license information.
+This project has received funding from the European Research Council (ERC)
+under the European Union’s Horizon 2020 research and innovation programme
+(grant agreement No 725899).
+*/
+#pragma once
+
+#include "../../data/FluidIndex.hpp"
+#include "../../data/FluidTensor.hpp"
+#include <Eigen/Core>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+namespace fluid {
+namespace impl {
+
+/// smallest power of two that holds at least `size` samples, so that ring
+/// positions can wrap with a mask
+constexpr index ringSize(index size)
+{
+  index n = 1;
+  while (n < size) n <<= 1;
+  return n;
+}
+
+template <typename T>
+using BlockMap = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+
+template <typename T>
+using ConstBlockMap = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+
+/// copy a (possibly strided) vector into contiguous storage
+template <typename T, typename U>
+void copyBlock(FluidTensorView<U, 1> in, T* out)
+{
+  using V = std::remove_const_t<U>;
+  if (in.descriptor().strides[0] != 1)
+    std::transform(in.begin(), in.end(), out,
+                   [](const V& x) { return static_cast<T>(x); });
+  else if constexpr (std::is_same<V, T>::value)
+    std::copy_n(in.data(), in.size(), out);
+  else
+    BlockMap<T>(out, in.size()) =
+        ConstBlockMap<V>(in.data(), in.size()).template cast<T>();
+}
+
+/// copy contiguous storage into a (possibly strided) vector
+template <typename T, typename U>
+void copyBlock(const T* in, FluidTensorView<U, 1> out)
+{
+  if (out.descriptor().strides[0] != 1)
+    std::transform(in, in + out.size(), out.begin(),
+                   [](const T& x) { return static_cast<U>(x); });
+  else if constexpr (std::is_same<U, T>::value)
+    std::copy_n(in, out.size(), out.data());
+  else
+    BlockMap<U>(out.data(), out.size()) =
+        ConstBlockMap<T>(in, out.size()).template cast<U>();
+}
+
+/// accumulate a (possibly strided) vector into contiguous storage
+template <typename T>
+void addBlock(FluidTensorView<const T, 1> in, T* out)
+{
+  if (in.descriptor().strides[0] != 1)
+    std::transform(in.begin(), in.end(), out, out, std::plus<T>());
+  else
+    BlockMap<T>(out, in.size()) += ConstBlockMap<T>(in.data(), in.size());
+}
+
+} // namespace impl
+} // namespace fluid
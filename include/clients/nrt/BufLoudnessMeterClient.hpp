@@ -0,0 +1,128 @@
+/*
+Part of the Fluid Corpus Manipulation Project (http://www.flucoma.org/)
+Copyright 2017-2019 University of Huddersfield.
+Licensed under the BSD-3 License.
+See license.md file in the project root for full license information.
+This project has received funding from the European Research Council (ERC)
+under the European Union’s Horizon 2020 research and innovation programme
+(grant agreement No 725899).
+*/
+#pragma once
+
+#include "../common/BufferAdaptor.hpp"
+#include "../common/FluidBaseClient.hpp"
+#include "../common/FluidNRTClientWrapper.hpp"
+#include "../common/ParameterConstraints.hpp"
+#include "../common/ParameterTypes.hpp"
+#include "../../algorithms/public/LoudnessMeter.hpp"
+
+namespace fluid {
+namespace client {
+namespace bufloudnessmeter {
+
+enum BufLoudnessMeterParamIndex {
+  kSource,
+  kStartFrame,
+  kNumFrames,
+  kStartChan,
+  kNumChans,
+  kFeatures
+};
+
+constexpr auto BufLoudnessMeterParams =
+    defineParameters(InputBufferParam("source", "Source Buffer"),
+                     LongParam("startFrame", "Source Offset", 0, Min(0)),
+                     LongParam("numFrames", "Number of Frames", -1),
+                     LongParam("startChan", "Start Channel", 0, Min(0)),
+                     LongParam("numChans", "Number of Channels", -1),
+                     BufferParam("features", "Features Buffer"));
+
+/// Measures a whole buffer in one pass, treating the selected channels as
+/// one programme. Writes four frames to a single channel: gated integrated
+/// loudness, loudness range, maximum momentary and maximum short-term
+/// loudness
+class BufLoudnessMeterClient : public FluidBaseClient,
+                               public OfflineIn,
+                               public OfflineOut
+{
+  static constexpr index blockSize = 4096;
+
+public:
+  using ParamDescType = decltype(BufLoudnessMeterParams);
+
+  using ParamSetViewType = ParameterSetView<ParamDescType>;
+  std::reference_wrapper<ParamSetViewType> mParams;
+
+  void setParams(ParamSetViewType& p) { mParams = p; }
+
+  template <size_t N>
+  auto& get() const
+  {
+    return mParams.get().template get<N>();
+  }
+
+  static constexpr auto& getParameterDescriptors()
+  {
+    return BufLoudnessMeterParams;
+  }
+
+  BufLoudnessMeterClient(ParamSetViewType& p, FluidContext&) : mParams(p) {}
+
+  template <typename T>
+  Result process(FluidContext& c)
+  {
+    index startFrame = get<kStartFrame>();
+    index numFrames = get<kNumFrames>();
+    index startChan = get<kStartChan>();
+    index numChans = get<kNumChans>();
+
+    Result r = bufferRangeCheck(get<kSource>().get(), startFrame, numFrames,
+                                startChan, numChans);
+
+    if (!r.ok()) return r;
+
+    BufferAdaptor::ReadAccess source(get<kSource>().get());
+    BufferAdaptor::Access     dest(get<kFeatures>().get());
+
+    if (!dest.exists())
+      return {Result::Status::kError, "Output buffer not found"};
+
+    double sampleRate = source.sampleRate();
+
+    algorithm::LoudnessMeter meter(numChans);
+    meter.init(numChans, sampleRate);
+
+    RealMatrix block(numChans, blockSize);
+    for (index i = 0; i < numFrames; i += blockSize)
+    {
+      index n = std::min(blockSize, numFrames - i);
+      auto  chunk = block(Slice(0), Slice(0, n));
+      for (index j = 0; j < numChans; ++j)
+        chunk.row(j) <<= source.samps(startFrame + i, n, startChan + j);
+      meter.processBlock(chunk);
+
+      if (c.task() &&
+          !c.task()->processUpdate(static_cast<double>(i + n),
+                                   static_cast<double>(numFrames)))
+        return {Result::Status::kCancelled, ""};
+    }
+
+    r = dest.resize(4, 1, sampleRate);
+    if (!r.ok()) return r;
+
+    auto out = dest.samps(0);
+    out(0) = static_cast<float>(meter.integrated());
+    out(1) = static_cast<float>(meter.range());
+    out(2) = static_cast<float>(meter.maxMomentary());
+    out(3) = static_cast<float>(meter.maxShortTerm());
+
+    return {};
+  }
+};
+} // namespace bufloudnessmeter
+
+using NRTThreadedBufLoudnessMeterClient =
+    NRTThreadingAdaptor<ClientWrapper<bufloudnessmeter::BufLoudnessMeterClient>>;
+
+} // namespace client
+} // namespace fluid
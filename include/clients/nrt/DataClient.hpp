@@ -20,6 +20,16 @@ under the European Union’s Horizon 2020 research and innovation programme
 namespace fluid {
 namespace client {
 
+// DataSets and LabelSets are streamed to and from JSON rather than going
+// through a DOM, as they can be very large
+template <typename T>
+struct isDataSet : std::false_type
+{};
+
+template <typename T>
+struct isDataSet<FluidDataSet<std::string, T, 1>> : std::true_type
+{};
+
 template <typename T>
 class DataClient
 {
@@ -47,36 +57,59 @@ public:
 
   MessageResult<void> read(string fileName)
   {
-    auto           file = JSONFile(fileName, "r");
-    nlohmann::json j = file.read();
-    if (!file.ok()) { return Error(file.error()); }
+    auto file = JSONFile(fileName, "r");
+    if constexpr (isDataSet<T>::value)
+    {
+      return file.read(mAlgorithm) ? OK() : Error(file.error());
+    }
     else
     {
-      if (!check_json(j, mAlgorithm)) return Error("Invalid JSON format");
-      mAlgorithm = j.get<T>();
+      nlohmann::json j = file.read();
+      if (!file.ok()) { return Error(file.error()); }
+      else
+      {
+        if (!check_json(j, mAlgorithm)) return Error("Invalid JSON format");
+        mAlgorithm = j.get<T>();
+      }
+      return OK();
     }
-    return OK();
   }
 
   MessageResult<string> dump()
   {
     using namespace nlohmann;
     if (!mAlgorithm.initialized()) return string();
-    nlohmann::json j = mAlgorithm;
-    return j.dump();
+    if constexpr (isDataSet<T>::value)
+    {
+      std::ostringstream result;
+      write_json(result, mAlgorithm, false);
+      return result.str();
+    }
+    else
+    {
+      nlohmann::json j = mAlgorithm;
+      return j.dump();
+    }
   }
 
   MessageResult<void> load(string s)
   {
     using namespace std;
     using namespace nlohmann;
-    json j = json::parse(s, nullptr, false);
-    if (j.is_discarded()) { return Error("Parse error"); }
+    if constexpr (isDataSet<T>::value)
+    {
+      return read_json(s, mAlgorithm) ? OK() : Error("Invalid JSON format");
+    }
     else
     {
-      if (!check_json(j, mAlgorithm)) return Error("Invalid JSON format");
-      mAlgorithm = j.get<T>();
-      return OK();
+      json j = json::parse(s, nullptr, false);
+      if (j.is_discarded()) { return Error("Parse error"); }
+      else
+      {
+        if (!check_json(j, mAlgorithm)) return Error("Invalid JSON format");
+        mAlgorithm = j.get<T>();
+        return OK();
+      }
     }
   }
   
@@ -14,6 +14,7 @@ under the European Union’s Horizon 2020 research and innovation programme
 #include "NRTClient.hpp"
 #include "../common/SharedClientUtils.hpp"
 #include "../../algorithms/public/DataSetIdSequence.hpp"
+#include "../../data/FluidBinaryFile.hpp"
 #include "../../data/FluidDataSet.hpp"
 #include <sstream>
 #include <string>
@@ -143,14 +144,29 @@ public:
     if (srcDataSet.size() == 0) return Error(EmptyDataSet);
     if (srcDataSet.pointSize() != mAlgorithm.pointSize())
       return Error(WrongPointSize);
-    auto       ids = srcDataSet.getIds();
-    RealVector point(srcDataSet.pointSize());
-    for (index i = 0; i < srcDataSet.size(); i++)
+    auto ids = srcDataSet.getIds();
+    auto points = srcDataSet.getData();
+    if (overwrite)
     {
-      srcDataSet.get(ids(i), point);
-      bool added = mAlgorithm.add(ids(i), point);
-      if (!added && overwrite) mAlgorithm.update(ids(i), point);
+      for (index i = 0; i < srcDataSet.size(); i++)
+        mAlgorithm.update(ids(i), points.row(i));
     }
+    mAlgorithm.addPoints(ids, points);
+    return OK();
+  }
+
+  MessageResult<void> writeBinary(string fileName, Optional<index> singlePrecision)
+  {
+    auto file = BinaryDataSetFile(fileName, "w");
+    file.write(mAlgorithm, singlePrecision.value_or(0) > 0);
+    return file.ok() ? OK() : Error(file.error());
+  }
+
+  MessageResult<void> readBinary(string fileName)
+  {
+    auto file = BinaryDataSetFile(fileName, "r");
+    if (!file.ok()) return Error(file.error());
+    mAlgorithm = file.read();
     return OK();
   }
 
@@ -280,6 +296,8 @@ public:
         makeMessage("clear", &DataSetClient::clear),
         makeMessage("write", &DataSetClient::write),
         makeMessage("read", &DataSetClient::read),
+        makeMessage("writeBinary", &DataSetClient::writeBinary),
+        makeMessage("readBinary", &DataSetClient::readBinary),
         makeMessage("fromBuffer", &DataSetClient::fromBuffer),
         makeMessage("toBuffer", &DataSetClient::toBuffer),
         makeMessage("getIds", &DataSetClient::getIds),
@@ -67,8 +67,9 @@ public:
     if (src.dims() != 2) return Error("Dataset should be 2D");
     if (src.size() == 0) return Error(EmptyDataSet);
     FluidDataSet<string, double, 1> result;
+    bool exact = src.size() <= algorithm::Grid::maxExactSize;
     result = mAlgorithm.process(src,
-        get<kResample>(), get<kExtent>(), get<kAxis>());
+        get<kResample>(), get<kExtent>(), get<kAxis>(), exact);
     destPtr->setDataSet(result);
     return OK();
   }
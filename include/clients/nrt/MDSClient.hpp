@@ -18,13 +18,15 @@ namespace fluid {
 namespace client {
 namespace mds {
 
-enum { kNumDimensions, kDistance };
+enum { kNumDimensions, kDistance, kMethod, kNumLandmarks };
 
 constexpr auto MDSParams = defineParameters(
     LongParam("numDimensions", "Target Number of Dimensions", 2, Min(1)),
     EnumParam("distanceMetric", "Distance Metric", 1, "Manhattan", "Euclidean",
               "Squared Euclidean", "Max Distance", "Min Distance",
-              "KL Divergence"));
+              "KL Divergence"),
+    EnumParam("method", "Method", 0, "Exact", "Landmark"),
+    LongParam("numLandmarks", "Number of Landmarks", 500, Min(2)));
 
 class MDSClient : public FluidBaseClient, OfflineIn, OfflineOut, ModelObject
 {
@@ -71,10 +73,15 @@ public:
     if (src.size() == 0) return Error(EmptyDataSet);
     if (k <= 0) return Error(SmallK);
     if (dist < 0 || dist > 6) return Error("dist should be  between 0 and 6");
+    if (get<kMethod>() == 1 && k >= src.size()) return Error(SmallDataSet);
 
     StringVector ids{src.getIds()};
     RealMatrix   output(src.size(), k);
-    mAlgorithm.process(src.getData(), output, dist, k);
+    if (get<kMethod>() == 0)
+      mAlgorithm.process(src.getData(), output, dist, k);
+    else
+      mAlgorithm.processLandmarks(src.getData(), output, dist, k,
+                                  get<kNumLandmarks>());
     FluidDataSet<string, double, 1> result(ids, output);
     destPtr->setDataSet(result);
     return OK();
@@ -47,7 +47,9 @@ enum NMFParamIndex {
   kEnvelopesUpdate,
   kRank,
   kIterations,
-  kFFT
+  kFFT,
+  kDivergence,
+  kTolerance
 };
 
 constexpr auto BufNMFParams = defineParameters(
@@ -66,7 +68,10 @@ constexpr auto BufNMFParams = defineParameters(
               "Fixed"),
     LongParam("components", "Number of Components", 1, Min(1)),
     LongParam("iterations", "Number of Iterations", 100, Min(1)),
-    FFTParam("fftSettings", "FFT Settings", 1024, -1, -1));
+    FFTParam("fftSettings", "FFT Settings", 1024, -1, -1),
+    EnumParam("divergence", "Divergence", 1, "Itakura-Saito",
+              "Kullback-Leibler", "Euclidean"),
+    FloatParam("tolerance", "Convergence Tolerance", 0, Min(0)));
 
 class NMFClient : public FluidBaseClient, public OfflineIn, public OfflineOut
 {
@@ -265,7 +270,8 @@ public:
           });
       nmf.process(magnitude, outputFilters, outputEnvelopes, outputMags,
                   get<kRank>(), get<kIterations>() * needsAnalysis, !fixFilters, !fixEnvelopes,
-                  seededFilters, seededEnvelopes);
+                  seededFilters, seededEnvelopes, get<kDivergence>(),
+                  get<kTolerance>());
 
       if (c.task() && c.task()->cancelled())
         return {Result::Status::kCancelled, ""};
@@ -32,7 +32,8 @@ enum NMFSeedParamIndex {
   kMaxRank,
   kCoverage,
   kMethod,
-  kFFT
+  kFFT,
+  kMaxFrames
 };
 
 constexpr auto NMFSeedParams =
@@ -46,7 +47,9 @@ constexpr auto NMFSeedParams =
                      FloatParam("coverage", "Coverage", 0.5, Min(0), Max(1)),
                      EnumParam("method", "Initialization Method", 0, "NMF-SVD",
                                "NNDSVDar", "NNDSVDa", "NNDSVD"),
-                     FFTParam("fftSettings", "FFT Settings", 1024, -1, -1));
+                     FFTParam("fftSettings", "FFT Settings", 1024, -1, -1),
+                     LongParam("maxFrames", "Maximum Number of Frames to Analyse",
+                               -1));
 
 class NMFSeedClient : public FluidBaseClient, public OfflineIn, public OfflineOut
 {
@@ -102,7 +105,8 @@ public:
 
     index rank = nndsvd.process(magnitude, outputFilters, outputEnvelopes,
                                 get<kMinRank>(), get<kMaxRank>(),
-                                get<kCoverage>(), get<kMethod>());
+                                get<kCoverage>(), get<kMethod>(),
+                                get<kMaxFrames>());
 
     auto   filters = BufferAdaptor::Access{get<kFilters>().get()};
     Result resizeResult =
@@ -0,0 +1,239 @@
+/*
+Part of the Fluid Corpus Manipulation Project (http://www.flucoma.org/)
+Copyright 2017-2019 University of Huddersfield.
+Licensed under the BSD-3 License.
+See license.md file in the project root for full license information.
+This project has received funding from the European Research Council (ERC)
+under the European Union’s Horizon 2020 research and innovation programme
+(grant agreement No 725899).
+*/
+#pragma once
+
+#include "../common/BufferAdaptor.hpp"
+#include "../common/FluidBaseClient.hpp"
+#include "../common/FluidNRTClientWrapper.hpp"
+#include "../common/ParameterConstraints.hpp"
+#include "../common/ParameterSet.hpp"
+#include "../common/ParameterTypes.hpp"
+#include "../../algorithms/public/OnlineNMF.hpp"
+#include "../../algorithms/public/STFT.hpp"
+#include "../../data/FluidTensor.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace fluid {
+namespace client {
+namespace bufonlinenmf {
+
+enum OnlineNMFParamIndex {
+  kSource,
+  kOffset,
+  kNumFrames,
+  kStartChan,
+  kNumChans,
+  kFilters,
+  kFiltersUpdate,
+  kEnvelopes,
+  kRank,
+  kIterations,
+  kBatchSize,
+  kDecay,
+  kFFT
+};
+
+constexpr auto BufOnlineNMFParams = defineParameters(
+    InputBufferParam("source", "Source Buffer"),
+    LongParam("startFrame", "Source Offset", 0, Min(0)),
+    LongParam("numFrames", "Number of Frames", -1),
+    LongParam("startChan", "Start Channel", 0, Min(0)),
+    LongParam("numChans", "Number Channels", -1),
+    BufferParam("bases", "Bases Buffer"),
+    EnumParam("basesMode", "Bases Buffer Update Mode", 0, "None", "Seed"),
+    BufferParam("activations", "Activations Buffer"),
+    LongParam("components", "Number of Components", 1, Min(1)),
+    LongParam("iterations", "Number of Iterations per Batch", 10, Min(1)),
+    LongParam("batchSize", "Spectral Frames per Batch", 128, Min(1)),
+    FloatParam("decay", "Decay of Past Batches", 0.9, Min(0), Max(1)),
+    FFTParam("fftSettings", "FFT Settings", 1024, -1, -1));
+
+/// Learns NMF bases from a buffer a batch of spectral frames at a time, so
+/// that only one batch of spectrum is ever held in memory. Activations, if
+/// requested, are written batch by batch against the bases as they stood at
+/// the time, then normalised to a peak of 1 as in BufNMF
+class OnlineNMFClient : public FluidBaseClient,
+                        public OfflineIn,
+                        public OfflineOut
+{
+public:
+  using ParamDescType = decltype(BufOnlineNMFParams);
+
+  using ParamSetViewType = ParameterSetView<ParamDescType>;
+  std::reference_wrapper<ParamSetViewType> mParams;
+
+  void setParams(ParamSetViewType& p) { mParams = p; }
+
+  template <size_t N>
+  auto& get() const
+  {
+    return mParams.get().template get<N>();
+  }
+
+  static constexpr auto& getParameterDescriptors()
+  {
+    return BufOnlineNMFParams;
+  }
+
+  OnlineNMFClient(ParamSetViewType& p, FluidContext&) : mParams{p} {}
+
+  template <typename T>
+  Result process(FluidContext& c)
+  {
+    index nFrames = get<kNumFrames>();
+    index nChannels = get<kNumChans>();
+    auto  rangeCheck = bufferRangeCheck(get<kSource>().get(), get<kOffset>(),
+                                       nFrames, get<kStartChan>(), nChannels);
+
+    if (!rangeCheck.ok()) return rangeCheck;
+
+    auto   source = BufferAdaptor::ReadAccess(get<kSource>().get());
+    double sampleRate = source.sampleRate();
+    auto   fftParams = get<kFFT>();
+    index  winSize = fftParams.winSize();
+    index  hopSize = fftParams.hopSize();
+    index  rank = get<kRank>();
+    index  batchSize = get<kBatchSize>();
+
+    index nWindows = static_cast<index>(
+        std::floor((nFrames + hopSize) / hopSize));
+    index nBins = fftParams.frameSize();
+
+    const bool seedFilters{get<kFiltersUpdate>() > 0};
+    const bool hasEnvelopes{static_cast<bool>(get<kEnvelopes>())};
+
+    if (!get<kFilters>())
+      return {Result::Status::kError, "No Bases Buffer supplied"};
+
+    {
+      BufferAdaptor::Access buf(get<kFilters>().get());
+      if (!buf.exists())
+        return {Result::Status::kError, "Bases Buffer Supplied But Invalid"};
+
+      if (seedFilters && (!buf.valid() || buf.numFrames() != nBins ||
+                          buf.numChans() != rank * nChannels))
+        return {Result::Status::kError,
+                "Supplied bases buffer for seeding must be [(FFTSize / 2) + "
+                "1] frames long, and have [rank] * [channels] channels"};
+
+      if (!seedFilters)
+      {
+        Result resizeResult = buf.resize(nBins, nChannels * rank,
+                                         sampleRate / fftParams.fftSize());
+        if (!resizeResult.ok()) return resizeResult;
+      }
+    }
+
+    if (hasEnvelopes)
+    {
+      BufferAdaptor::Access buf(get<kEnvelopes>().get());
+      if (!buf.exists())
+        return {Result::Status::kError,
+                "Activations Buffer Supplied But Invalid"};
+      Result resizeResult =
+          buf.resize(nWindows, nChannels * rank, sampleRate / hopSize);
+      if (!resizeResult.ok()) return resizeResult;
+    }
+
+    auto stft = algorithm::STFT(winSize, fftParams.fftSize(), hopSize);
+    auto nmf = algorithm::OnlineNMF(nBins, rank, batchSize);
+
+    index segmentSize = (batchSize - 1) * hopSize + winSize;
+    auto  segment = FluidTensor<double, 1>(segmentSize);
+    auto  spectrum = FluidTensor<std::complex<double>, 2>(batchSize, nBins);
+    auto  magnitude = FluidTensor<double, 2>(batchSize, nBins);
+    auto  activations = FluidTensor<double, 2>(batchSize, rank);
+    auto  filters = FluidTensor<double, 2>(rank, nBins);
+
+    index        nBatches = (nWindows + batchSize - 1) / batchSize;
+    const double progressTotal = static_cast<double>(nBatches * nChannels);
+    index        progressCount = 0;
+
+    for (index i = 0; i < nChannels; ++i)
+    {
+      if (seedFilters)
+      {
+        BufferAdaptor::Access buf(get<kFilters>().get());
+        for (index j = 0; j < rank; ++j)
+          filters.row(j) <<= buf.samps(i * rank + j);
+        nmf.init(filters);
+      }
+      else
+        nmf.init(nBins, rank);
+
+      for (index start = 0; start < nWindows; start += batchSize)
+      {
+        index n = std::min(batchSize, nWindows - start);
+
+        // the audio under this batch's windows, zero padded as by STFT
+        index first = start * hopSize - winSize / 2;
+        index last = first + (n - 1) * hopSize + winSize;
+        index lo = std::max<index>(first, 0);
+        index hi = std::min(last, nFrames);
+        segment.fill(0);
+        if (hi > lo)
+          segment(Slice(lo - first, hi - lo)) <<= source.samps(
+              get<kOffset>() + lo, hi - lo, get<kStartChan>() + i);
+
+        for (index j = 0; j < n; ++j)
+          stft.processFrame(segment(Slice(j * hopSize, winSize)),
+                            spectrum.row(j));
+        auto mags = magnitude(Slice(0, n), Slice(0));
+        algorithm::STFT::magnitude(spectrum(Slice(0, n), Slice(0)), mags);
+
+        auto acts = activations(Slice(0, n), Slice(0));
+        nmf.processBatch(mags,
+                         hasEnvelopes ? acts : RealMatrixView(nullptr, 0, 0, 0),
+                         get<kIterations>(), true, get<kDecay>());
+
+        if (hasEnvelopes)
+        {
+          BufferAdaptor::Access buf(get<kEnvelopes>().get());
+          for (index j = 0; j < rank; ++j)
+            buf.samps(start, n, i * rank + j) <<= acts.col(j);
+        }
+
+        if (c.task() &&
+            !c.task()->processUpdate(static_cast<double>(++progressCount),
+                                     progressTotal))
+          return {Result::Status::kCancelled, ""};
+      }
+
+      nmf.getW(filters);
+      BufferAdaptor::Access buf(get<kFilters>().get());
+      for (index j = 0; j < rank; ++j)
+        buf.samps(i * rank + j) <<= filters.row(j);
+
+      if (hasEnvelopes)
+      {
+        BufferAdaptor::Access envelopes(get<kEnvelopes>().get());
+        float maxH = 0;
+        for (index j = 0; j < rank; ++j)
+        {
+          auto env = envelopes.samps(i * rank + j);
+          maxH = std::max(maxH, *std::max_element(env.begin(), env.end()));
+        }
+        auto scale = maxH > 0 ? 1.f / maxH : 1.f;
+        for (index j = 0; j < rank; ++j)
+          envelopes.samps(i * rank + j).apply(
+              [scale](float& x) { x *= scale; });
+      }
+    }
+    return {Result::Status::kOk, ""};
+  }
+};
+} // namespace bufonlinenmf
+
+using NRTThreadedOnlineNMFClient =
+    NRTThreadingAdaptor<ClientWrapper<bufonlinenmf::OnlineNMFClient>>;
+
+} // namespace client
+} // namespace fluid
@@ -123,13 +123,12 @@ public:
       auto srcDataSet = srcPtr->getDataSet();
       if (srcDataSet.size() == 0) return Error<void>(EmptyDataSet);
       if (!mAlgorithm.initialized()) return Error<void>(NoDataFitted);
+      if (srcDataSet.pointSize() > mAlgorithm.size())
+        return Error<void>(WrongPointSize);
       StringVector ids{srcDataSet.getIds()};
-      RealMatrix   paddedInput(srcPtr->size(), mAlgorithm.dims());
-      auto         inputData = srcDataSet.getData();
-      paddedInput(Slice(0, inputData.rows()), Slice(0, inputData.cols())) <<=
-          inputData;
-      RealMatrix output(srcDataSet.size(), mAlgorithm.dims());
-      mAlgorithm.inverseProcess(paddedInput, output,get<kWhiten>() == 1);
+      RealMatrix   output(srcDataSet.size(), mAlgorithm.dims());
+      mAlgorithm.inverseProcess(srcDataSet.getData(), output,
+                                get<kWhiten>() == 1);
       FluidDataSet<string, double, 1> result(ids, output);
       destPtr->setDataSet(result);
       return {};
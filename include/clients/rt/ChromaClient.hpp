@@ -98,7 +98,7 @@ public:
     auto chroma = mChroma(Slice(0,nChroma));
 
     mSTFTBufferedProcess.processInput(
-        get<kFFT>(), input, c, [&](ComplexMatrixView in) {
+        get<kFFT>(), input, c, [&](ConstComplexMatrixView in) {
           algorithm::STFT::magnitude(in.row(0), mags);
           mAlgorithm.processFrame(mags, chroma, get<kMinFreq>(),
                                   get<kMaxFreq>(), get<kNorm>());
@@ -112,7 +112,7 @@ public:
 
   void reset(FluidContext const& c)
   {
-    mSTFTBufferedProcess.reset();
+    mSTFTBufferedProcess.reset(c, get<kFFT>());
     mAlgorithm.init(get<kNChroma>(), get<kFFT>().frameSize(), get<kRef>(),
                     sampleRate(), c.allocator());
   }
@@ -0,0 +1,122 @@
+/*
+Part of the Fluid Corpus Manipulation Project (http://www.flucoma.org/)
+Copyright 2017-2019 University of Huddersfield.
+Licensed under the BSD-3 License.
+See license.md file in the project root for full license information.
+This project has received funding from the European Research Council (ERC)
+under the European Union’s Horizon 2020 research and innovation programme
+(grant agreement No 725899).
+*/
+#pragma once
+
+#include "../common/AudioClient.hpp"
+#include "../common/FluidBaseClient.hpp"
+#include "../common/ParameterConstraints.hpp"
+#include "../common/ParameterSet.hpp"
+#include "../common/ParameterTypes.hpp"
+#include "../../algorithms/public/LoudnessMeter.hpp"
+#include "../../data/TensorTypes.hpp"
+
+namespace fluid {
+namespace client {
+namespace loudnessmeter {
+
+template <typename T>
+using HostVector = FluidTensorView<T, 1>;
+
+enum LoudnessMeterParamIndex { kSelect };
+
+constexpr auto LoudnessMeterParams = defineParameters(
+    ChoicesParam("select", "Selection of Outputs", "momentary", "shortTerm",
+                 "integrated", "range"));
+
+class LoudnessMeterClient : public FluidBaseClient,
+                            public AudioIn,
+                            public ControlOut
+{
+  static constexpr index mMaxFeatures = 4;
+
+public:
+  using ParamDescType = decltype(LoudnessMeterParams);
+
+  using ParamSetViewType = ParameterSetView<ParamDescType>;
+  std::reference_wrapper<ParamSetViewType> mParams;
+
+  void setParams(ParamSetViewType& p) { mParams = p; }
+
+  template <size_t N>
+  auto& get() const
+  {
+    return mParams.get().template get<N>();
+  }
+
+  static constexpr auto& getParameterDescriptors()
+  {
+    return LoudnessMeterParams;
+  }
+
+  LoudnessMeterClient(ParamSetViewType& p, FluidContext& c)
+      : mParams(p), mAlgorithm(1, c.allocator())
+  {
+    audioChannelsIn(1);
+    controlChannelsOut({1, mMaxFeatures});
+    setInputLabels({"audio input"});
+    setOutputLabels({"momentary, short-term, integrated loudness (LUFS) and "
+                     "loudness range (LU)"});
+  }
+
+  template <typename T>
+  void process(std::vector<HostVector<T>>& input,
+               std::vector<HostVector<T>>& output, FluidContext& c)
+  {
+    if (!input[0].data() || !output[0].data()) return;
+    assert(FluidBaseClient::controlChannelsOut().size && "No control channels");
+    assert(output[0].size() >= FluidBaseClient::controlChannelsOut().size &&
+           "Too few output channels");
+
+    if (mSampleRateTracker.changed(sampleRate()))
+      mAlgorithm.init(1, sampleRate());
+
+    RealMatrix in(1, input[0].size(), c.allocator());
+    in.row(0) <<= input[0];
+    mAlgorithm.processBlock(in);
+
+    auto  selection = get<kSelect>();
+    index numOuts = asSigned(selection.count());
+    index i = 0;
+    controlChannelsOut({1, numOuts, mMaxFeatures});
+
+    if (selection[0]) output[0](i++) = static_cast<T>(mAlgorithm.momentary());
+    if (selection[1]) output[0](i++) = static_cast<T>(mAlgorithm.shortTerm());
+    if (selection[2]) output[0](i++) = static_cast<T>(mAlgorithm.integrated());
+    if (selection[3]) output[0](i++) = static_cast<T>(mAlgorithm.range());
+
+    output[0](Slice(numOuts, mMaxFeatures - numOuts)).fill(0);
+  }
+
+  index latency() { return 0; }
+
+  void reset(FluidContext&) { mAlgorithm.init(1, sampleRate()); }
+
+  MessageResult<void> clear()
+  {
+    if (mAlgorithm.initialized()) mAlgorithm.reset();
+    return {};
+  }
+
+  static auto getMessageDescriptors()
+  {
+    return defineMessages(makeMessage("clear", &LoudnessMeterClient::clear));
+  }
+
+private:
+  ParameterTrackChanges<double> mSampleRateTracker;
+  algorithm::LoudnessMeter      mAlgorithm;
+};
+} // namespace loudnessmeter
+
+using RTLoudnessMeterClient =
+    ClientWrapper<loudnessmeter::LoudnessMeterClient>;
+
+} // namespace client
+} // namespace fluid
@@ -120,7 +120,7 @@ public:
     auto coefs = mCoefficients(Slice(0, std::min(nCoefs + !has0, nBands))); //making sure that we don't ask for more than nBands coeff in case of has0
 
     mSTFTBufferedProcess.processInput(
-        get<kFFT>(), input, c, [&](ComplexMatrixView in) {
+        get<kFFT>(), input, c, [&](ConstComplexMatrixView in) {
           algorithm::STFT::magnitude(in.row(0), mags);
           mMelBands.processFrame(mags, bands, false, false, true, c.allocator());
           mDCT.processFrame(bands, coefs);
@@ -136,7 +136,7 @@ public:
   {
     index nBands = get<kNBands>();
 
-    mSTFTBufferedProcess.reset();
+    mSTFTBufferedProcess.reset(c, get<kFFT>());
     mMagnitude.resize(get<kFFT>().frameSize());
     mBands.resize(nBands);
     mCoefficients.resize(get<kNCoefs>().max() + 1); //same as line 79
@@ -107,7 +107,7 @@ public:
     auto bands = mBands(Slice(0,nBands));
     
     mSTFTBufferedProcess.processInput(
-        get<kFFT>(), input, c, [&](ComplexMatrixView in) {
+        get<kFFT>(), input, c, [&](ConstComplexMatrixView in) {
           algorithm::STFT::magnitude(in.row(0), mags);
           mMelBands.processFrame(mags, bands, get<kNormalize>() == 1,
                                  false, get<kScale>() == 1, c.allocator());
@@ -122,7 +122,7 @@ public:
 
   void reset(FluidContext& c)
   {
-    mSTFTBufferedProcess.reset();
+    mSTFTBufferedProcess.reset(c, get<kFFT>());
     mMelBands.init(get<kMinFreq>(), get<kMaxFreq>(), get<kNBands>(),
                    get<kFFT>().frameSize(), sampleRate(),
                    get<kFFT>().winSize(), c.allocator());
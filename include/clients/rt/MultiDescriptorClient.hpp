@@ -0,0 +1,198 @@
+/*
+Part of the Fluid Corpus Manipulation Project (http://www.flucoma.org/)
+Copyright 2017-2019 University of Huddersfield.
+Licensed under the BSD-3 License.
+See license.md file in the project root for full license information.
+This project has received funding from the European Research Council (ERC)
+under the European Union’s Horizon 2020 research and innovation programme
+(grant agreement No 725899).
+*/
+#pragma once
+
+#include "../common/AudioClient.hpp"
+#include "../common/BufferedProcess.hpp"
+#include "../common/FluidBaseClient.hpp"
+#include "../common/FluidNRTClientWrapper.hpp"
+#include "../common/ParameterConstraints.hpp"
+#include "../common/ParameterSet.hpp"
+#include "../common/ParameterTypes.hpp"
+#include "../../algorithms/public/MultiDescriptor.hpp"
+#include "../../data/TensorTypes.hpp"
+
+namespace fluid {
+namespace client {
+namespace multidescriptor {
+
+using algorithm::MultiDescriptor;
+
+enum MultiDescriptorParamIndex {
+  kNBands,
+  kNCoefs,
+  kMinFreq,
+  kMaxFreq,
+  kPitchMinFreq,
+  kPitchMaxFreq,
+  kAmpMeasure,
+  kKWeighting,
+  kTruePeak,
+  kFFT
+};
+
+constexpr auto MultiDescriptorParams = defineParameters(
+    LongParamRuntimeMax<Primary>("numBands", "Number of Mel Bands", 40, Min(2),
+                                 FrameSizeUpperLimit<kFFT>(),
+                                 LowerLimit<kNCoefs>()),
+    LongParamRuntimeMax<Primary>("numCoeffs",
+                                 "Number of Cepstral Coefficients", 13, Min(2),
+                                 UpperLimit<kNBands>()),
+    FloatParam("minFreq", "Low Frequency Bound", 20, Min(0)),
+    FloatParam("maxFreq", "High Frequency Bound", 20000, Min(-1)),
+    FloatParam("pitchMinFreq", "Pitch Low Frequency Bound", 20, Min(0),
+               Max(10000), UpperLimit<kPitchMaxFreq>()),
+    FloatParam("pitchMaxFreq", "Pitch High Frequency Bound", 10000, Min(1),
+               Max(20000), LowerLimit<kPitchMinFreq>()),
+    EnumParam("power", "Use Power", 0, "No", "Yes"),
+    EnumParam("kWeighting", "Apply K-Weighting", 1, "Off", "On"),
+    EnumParam("truePeak", "Compute True Peak", 1, "Off", "On"),
+    FFTParam("fftSettings", "FFT Settings", 1024, -1, -1));
+
+class MultiDescriptorClient : public FluidBaseClient,
+                              public AudioIn,
+                              public ControlOut
+{
+public:
+  using ParamDescType = decltype(MultiDescriptorParams);
+
+  using ParamSetViewType = ParameterSetView<ParamDescType>;
+  std::reference_wrapper<ParamSetViewType> mParams;
+
+  void setParams(ParamSetViewType& p)
+  {
+    mParams = p;
+    controlChannelsOut({1, outputSize(), maxOutputSize()});
+  }
+
+  template <size_t N>
+  auto get() const -> decltype(mParams.get().template get<N>())
+  {
+    return mParams.get().template get<N>();
+  }
+
+  static constexpr auto& getParameterDescriptors()
+  {
+    return MultiDescriptorParams;
+  }
+
+  MultiDescriptorClient(ParamSetViewType& p, FluidContext& c)
+      : mParams{p}, mAlgorithm(get<kFFT>().max(), get<kNBands>().max(),
+                               get<kNCoefs>().max(), c.allocator()),
+        mBufferedProcess(get<kFFT>().max(), 0, 1, 0, c.hostVectorSize(),
+                         c.allocator()),
+        mDescriptors(maxOutputSize(), c.allocator())
+  {
+    audioChannelsIn(1);
+    controlChannelsOut({1, outputSize(), maxOutputSize()});
+    setInputLabels({"audio input"});
+    setOutputLabels({"mel bands, mfccs, shape, pitch and loudness"});
+  }
+
+  template <typename T>
+  void process(std::vector<HostVector<T>>& input,
+               std::vector<HostVector<T>>& output, FluidContext& c)
+  {
+    if (!input[0].data() || !output[0].data()) return;
+    assert(controlChannelsOut().count && "No control channels");
+    assert(output[0].size() >= controlChannelsOut().size &&
+           "Too few output channels");
+
+    index hostVecSize = input[0].size();
+    index nBands = get<kNBands>();
+    index nCoefs = get<kNCoefs>();
+    index size = outputSize();
+
+    if (mTracker.changed(get<kFFT>().winSize(), get<kFFT>().fftSize(), nBands,
+                         nCoefs, sampleRate()))
+    {
+      mAlgorithm.init(get<kFFT>().winSize(), get<kFFT>().fftSize(), nBands,
+                      nCoefs, sampleRate(), c.allocator());
+      controlChannelsOut({1, size, maxOutputSize()});
+    }
+
+    if (mHostSizeTracker.changed(hostVecSize))
+    {
+      mBufferedProcess = BufferedProcess(get<kFFT>().max(), 0, 1, 0,
+                                         hostVecSize, c.allocator());
+    }
+
+    auto descriptors = mDescriptors(Slice(0, size));
+
+    RealMatrix in(1, hostVecSize, c.allocator());
+    in.row(0) <<= input[0];
+    mBufferedProcess.push(RealMatrixView(in));
+    mBufferedProcess.processInput(
+        get<kFFT>().winSize(), get<kFFT>().hopSize(), c,
+        [&](RealMatrixView frame) {
+          mAlgorithm.processFrame(frame.row(0), descriptors, get<kMinFreq>(),
+                                  get<kMaxFreq>(), get<kPitchMinFreq>(),
+                                  get<kPitchMaxFreq>(), get<kAmpMeasure>() == 1,
+                                  get<kKWeighting>() == 1,
+                                  get<kTruePeak>() == 1, c.allocator());
+        });
+
+    for (index i = 0; i < size; i++)
+      output[0](i) = static_cast<T>(descriptors(i));
+    output[0](Slice(size, maxOutputSize() - size)).fill(0);
+  }
+
+  index latency() { return get<kFFT>().winSize(); }
+
+  void reset(FluidContext& c)
+  {
+    mBufferedProcess.reset();
+    mAlgorithm.init(get<kFFT>().winSize(), get<kFFT>().fftSize(),
+                    get<kNBands>(), get<kNCoefs>(), sampleRate(),
+                    c.allocator());
+  }
+
+  AnalysisSize analysisSettings()
+  {
+    return {get<kFFT>().winSize(), get<kFFT>().hopSize()};
+  }
+
+private:
+  index outputSize() const
+  {
+    return MultiDescriptor::size(get<kNBands>(), get<kNCoefs>());
+  }
+
+  index maxOutputSize() const
+  {
+    return MultiDescriptor::size(get<kNBands>().max(), get<kNCoefs>().max());
+  }
+
+  ParameterTrackChanges<index, index, index, index, double> mTracker;
+  ParameterTrackChanges<index>                              mHostSizeTracker;
+  MultiDescriptor                                           mAlgorithm;
+  BufferedProcess                                           mBufferedProcess;
+  FluidTensor<double, 1>                                    mDescriptors;
+};
+} // namespace multidescriptor
+
+using RTMultiDescriptorClient =
+    ClientWrapper<multidescriptor::MultiDescriptorClient>;
+
+auto constexpr NRTMultiDescriptorParams =
+    makeNRTParams<multidescriptor::MultiDescriptorClient>(
+        InputBufferParam("source", "Source Buffer"),
+        BufferParam("features", "Features Buffer"));
+
+using NRTMultiDescriptorClient =
+    NRTControlAdaptor<multidescriptor::MultiDescriptorClient,
+                      decltype(NRTMultiDescriptorParams),
+                      NRTMultiDescriptorParams, 1, 1>;
+
+using NRTThreadedMultiDescriptorClient =
+    NRTThreadingAdaptor<NRTMultiDescriptorClient>;
+
+} // namespace client
+} // namespace fluid
@@ -22,13 +22,14 @@ namespace fluid {
 namespace client {
 namespace nmffilter {
 
-enum NMFFilterIndex { kFilterbuf, kMaxRank, kIterations, kFFT };
+enum NMFFilterIndex { kFilterbuf, kMaxRank, kIterations, kFFT, kTolerance };
 
 constexpr auto NMFFilterParams = defineParameters(
     InputBufferParam("bases", "Bases Buffer"),
     LongParamRuntimeMax<Primary>("maxComponents", "Maximum Number of Components", 20, Min(1)),
     LongParam("iterations", "Number of Iterations", 10, Min(1)),
-    FFTParam("fftSettings", "FFT Settings", 1024, -1, -1));
+    FFTParam("fftSettings", "FFT Settings", 1024, -1, -1),
+    FloatParam("tolerance", "Convergence Tolerance", 1e-3, Min(0)));
 
 class NMFFilterClient : public FluidBaseClient, public AudioIn, public AudioOut
 {
@@ -52,7 +53,14 @@ public:
   NMFFilterClient(ParamSetViewType& p, FluidContext& c)
       : mParams{p}, mSTFTProcessor{get<kFFT>(), 1, get<kMaxRank>().max(),
                                    c.hostVectorSize(), c.allocator()},
-        mMask{get<kMaxRank>().max(), get<kFFT>().maxFrameSize(), c.allocator()}
+        mNMF{get<kMaxRank>().max(), get<kFFT>().maxFrameSize(), c.allocator()},
+        mMask{get<kMaxRank>().max(), get<kFFT>().maxFrameSize(), c.allocator()},
+        mFilter(get<kMaxRank>().max(), get<kFFT>().maxFrameSize(),
+                c.allocator()),
+        mMagnitude(1, get<kFFT>().maxFrameSize(), c.allocator()),
+        mActivations(get<kMaxRank>().max(), c.allocator()),
+        mEstimate(1, get<kFFT>().maxFrameSize(), c.allocator()),
+        mSource(1, get<kFFT>().maxFrameSize(), c.allocator())
   {
     audioChannelsIn(1);
     audioChannelsOut(get<kMaxRank>().max());
@@ -62,7 +70,11 @@ public:
 
   index latency() { return get<kFFT>().winSize(); }
 
-  void reset(FluidContext&) { mSTFTProcessor.reset(); }
+  void reset(FluidContext&)
+  {
+    mSTFTProcessor.reset();
+    mNMF.resetActivations();
+  }
 
   template <typename T>
   void process(std::vector<HostVector<T>>& input,
@@ -82,53 +94,62 @@ public:
       if (!filterBuffer.valid()) { return; }
 
       index rank = std::min<index>(filterBuffer.numChans(), get<kMaxRank>().max());
+      index frameSize = fftParams.frameSize();
 
-      if (filterBuffer.numFrames() != fftParams.frameSize()) { return; }
+      if (filterBuffer.numFrames() != frameSize) { return; }
 
-      if (mTrackValues.changed(rank, fftParams.frameSize()))
+      auto filter = mFilter(Slice(0, rank), Slice(0, frameSize));
+      auto magnitude = mMagnitude(Slice(0), Slice(0, frameSize));
+      auto activations = mActivations(Slice(0, rank));
+      auto estimate = mEstimate(Slice(0), Slice(0, frameSize));
+      auto source = mSource(Slice(0), Slice(0, frameSize));
+
+      // only repack the bases when the buffer has actually changed
+      bool changed = mTrackValues.changed(rank, frameSize);
+      for (index i = 0; i < rank; ++i)
       {
-        tmpFilt.resize(rank, fftParams.frameSize());
-        tmpMagnitude.resize(1, fftParams.frameSize());
-        tmpOut.resize(rank);
-        tmpEstimate.resize(1, fftParams.frameSize());
-        tmpSource.resize(1, fftParams.frameSize());
+        auto samps = filterBuffer.samps(i);
+        for (index j = 0; j < frameSize; ++j)
+        {
+          if (filter(i, j) != samps(j))
+          {
+            filter(i, j) = samps(j);
+            changed = true;
+          }
+        }
       }
-
-      for (index i = 0; i < tmpFilt.rows(); ++i)
-        tmpFilt.row(i) <<= filterBuffer.samps(i);
+      if (changed) mNMF.init(filter);
 
       //      controlTrigger(false);
       mSTFTProcessor.process(
           get<kFFT>(), input, output, c,
           [&](ComplexMatrixView in, ComplexMatrixView out) {
-            algorithm::STFT::magnitude(in, tmpMagnitude);
-            mNMF.processFrame(tmpMagnitude.row(0), tmpFilt, tmpOut,
-                              get<kIterations>(), tmpEstimate.row(0), c.allocator());
-            mMask.init(tmpEstimate);
+            algorithm::STFT::magnitude(in, magnitude);
+            mNMF.processFrame(magnitude.row(0), activations,
+                              get<kIterations>(), get<kTolerance>(),
+                              estimate.row(0));
+            mMask.init(estimate);
             for (index i = 0; i < rank; ++i)
             {
-              algorithm::NMF::estimate(tmpFilt, RealMatrixView(tmpOut), i,
-                                       tmpSource);
-              mMask.process(in, RealMatrixView(tmpSource), 1,
-                            ComplexMatrixView{out.row(i)});
+              mNMF.estimate(i, source.row(0));
+              mMask.process(in, source, 1, ComplexMatrixView{out.row(i)});
             }
           });
     }
   }
 
 private:
-  ParameterTrackChanges<index, index>               mTrackValues;
-  STFTBufferedProcess<true> mSTFTProcessor;
+  ParameterTrackChanges<index, index> mTrackValues;
+  STFTBufferedProcess<true>           mSTFTProcessor;
 
   algorithm::NMF       mNMF;
   algorithm::RatioMask mMask;
 
-  RealMatrix a;
-  RealMatrix tmpFilt;
-  RealMatrix tmpMagnitude;
-  RealVector tmpOut;
-  RealMatrix tmpEstimate;
-  RealMatrix tmpSource;
+  RealMatrix mFilter;
+  RealMatrix mMagnitude;
+  RealVector mActivations;
+  RealMatrix mEstimate;
+  RealMatrix mSource;
 };
 } // namespace nmffilter
 
@@ -25,7 +25,8 @@ enum NMFMatchParamIndex {
   kFilterbuf,
   kMaxRank,
   kIterations,
-  kFFT
+  kFFT,
+  kTolerance
 };
 
 constexpr auto NMFMatchParams = defineParameters(
@@ -33,7 +34,8 @@ constexpr auto NMFMatchParams = defineParameters(
     LongParamRuntimeMax<Primary>("maxComponents", "Maximum Number of Components", 20,
                            Min(1)),
     LongParam("iterations", "Number of Iterations", 10, Min(1)),
-    FFTParam("fftSettings", "FFT Settings", 1024, -1, -1));
+    FFTParam("fftSettings", "FFT Settings", 1024, -1, -1),
+    FloatParam("tolerance", "Convergence Tolerance", 1e-3, Min(0)));
 
 class NMFMatchClient : public FluidBaseClient, public AudioIn, public ControlOut
 {
@@ -55,6 +57,7 @@ public:
 
   NMFMatchClient(ParamSetViewType& p, FluidContext& c)
       : mParams(p),
+        mNMF(get<kMaxRank>().max(), get<kFFT>().maxFrameSize(), c.allocator()),
         mFilter(get<kMaxRank>().max(),get<kFFT>().maxFrameSize(),c.allocator()),
         mMagnitude(1, get<kFFT>().maxFrameSize(),c.allocator()),
         mActivations(get<kMaxRank>().max(), c.allocator()),
@@ -68,7 +71,11 @@ public:
 
   index latency() { return get<kFFT>().winSize(); }
 
-  void reset(FluidContext&) { mSTFTProcessor.reset(); }
+  void reset(FluidContext& c)
+  {
+    mSTFTProcessor.reset(c, get<kFFT>());
+    mNMF.resetActivations();
+  }
 
   template <typename T>
   void process(std::vector<HostVector<T>>& input,
@@ -92,22 +99,32 @@ public:
 
       if (filterBuffer.numFrames() != frameSize) { return; }
       
-      if (mTrackValues.changed(rank, frameSize))
-      {
-        controlChannelsOut({1, rank});
-      }
-
       auto mags = mMagnitude(Slice(0),Slice(0,frameSize));
       auto filter = mFilter(Slice(0,rank),Slice(0,frameSize));
       auto activations = mActivations(Slice(0,rank));
-      
-      for (index i = 0; i < filter.rows(); ++i)
-        filter.row(i) <<= filterBuffer.samps(i);
 
-      mSTFTProcessor.processInput(get<kFFT>(), input, c, [&](ComplexMatrixView in) {
+      // only repack the bases when the buffer has actually changed
+      bool changed = mTrackValues.changed(rank, frameSize);
+      if (changed) controlChannelsOut({1, rank});
+      for (index i = 0; i < rank; ++i)
+      {
+        auto samps = filterBuffer.samps(i);
+        for (index j = 0; j < frameSize; ++j)
+        {
+          if (filter(i, j) != samps(j))
+          {
+            filter(i, j) = samps(j);
+            changed = true;
+          }
+        }
+      }
+      if (changed) mNMF.init(filter);
+
+      mSTFTProcessor.processInput(get<kFFT>(), input, c, [&](ConstComplexMatrixView in) {
         algorithm::STFT::magnitude(in, mags);
-        mNMF.processFrame(mags.row(0), filter, activations,
-            10, FluidTensorView<double,1>{nullptr, 0, 0}, c.allocator());
+        mNMF.processFrame(mags.row(0), activations, get<kIterations>(),
+                          get<kTolerance>(),
+                          FluidTensorView<double, 1>{nullptr, 0, 0});
       });
 
       output[0](Slice(0,rank)) <<= activations;
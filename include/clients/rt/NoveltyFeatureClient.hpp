@@ -79,6 +79,7 @@ public:
         mMelBands{40, get<kFFT>().max(), c.allocator()},
         mDCT{40, 13, c.allocator()},
         mChroma{12, get<kFFT>().max(), c.allocator()},
+        mYinFFT{get<kFFT>().maxFrameSize(), c.allocator()},
         mLoudness{get<kFFT>().max(), c.allocator()}
   {
     audioChannelsIn(1);
@@ -110,6 +111,7 @@ public:
           12, get<kFFT>().frameSize(), 440, sampleRate(), c.allocator());
       nDims = 12;
     }
+    else if (feature == 3) { mYinFFT.init(get<kFFT>().frameSize()); }
     else if (feature == 4)
     {
       mLoudness.init(windowSize, sampleRate(), c.allocator());
@@ -132,7 +134,8 @@ public:
     index frameSize = get<kFFT>().frameSize();
     index featureIdx = get<kFeature>();
     if (mParamsTracker.changed(hostVecSize, get<kFeature>(), get<kKernelSize>(),
-            get<kFilterSize>(), windowSize, sampleRate()))
+            get<kFilterSize>(), windowSize, get<kFFT>().frameSize(),
+            sampleRate()))
     {
       initAlgorithms(featureIdx, windowSize, c);
       mBufferedProcess = BufferedProcess{get<kFFT>().max(), 0, 1, 0,
@@ -202,7 +205,7 @@ public:
 
 private:
   algorithm::NoveltyFeature mNovelty;
-  ParameterTrackChanges<index, index, index, index, index, double>
+  ParameterTrackChanges<index, index, index, index, index, index, double>
                                        mParamsTracker;
   BufferedProcess                      mBufferedProcess;
   algorithm::STFT                      mSTFT;
@@ -87,9 +87,9 @@ public:
                                             c.allocator()},
         mMelBands{40, get<kFFT>().max(), c.allocator()}, mDCT{40, 13,
                                                               c.allocator()},
-        mChroma{12, get<kFFT>().max(), c.allocator()}, mLoudness{
-                                                           get<kFFT>().max(),
-                                                           c.allocator()}
+        mChroma{12, get<kFFT>().max(), c.allocator()},
+        mYinFFT{get<kFFT>().maxFrameSize(), c.allocator()},
+        mLoudness{get<kFFT>().max(), c.allocator()}
 
   {
     audioChannelsIn(1);
@@ -121,6 +121,7 @@ public:
                    c.allocator());
       nDims = 12;
     }
+    else if (feature == 3) { mYinFFT.init(get<kFFT>().frameSize()); }
     else if (feature == 4)
     {
       mLoudness.init(windowSize, sampleRate(), c.allocator());
@@ -143,7 +144,8 @@ public:
     index frameSize = get<kFFT>().frameSize();
     index featureIdx = get<kFeature>();
     if (mParamsTracker.changed(hostVecSize, get<kFeature>(), get<kKernelSize>(),
-                               get<kFilterSize>(), windowSize, sampleRate()))
+                               get<kFilterSize>(), windowSize,
+                               get<kFFT>().frameSize(), sampleRate()))
     {
       initAlgorithms(featureIdx, windowSize, c);
     }
@@ -217,7 +219,7 @@ public:
 
 private:
   algorithm::NoveltySegmentation mNovelty;
-  ParameterTrackChanges<index, index, index, index, index, double>
+  ParameterTrackChanges<index, index, index, index, index, index, double>
                                        mParamsTracker;
   BufferedProcess                      mBufferedProcess;
   algorithm::STFT                      mSTFT;
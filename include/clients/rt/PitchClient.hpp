@@ -79,6 +79,7 @@ public:
   PitchClient(ParamSetViewType& p, FluidContext& c)
       : mParams(p), mSTFTBufferedProcess(get<kFFT>(), 1, 0, c.hostVectorSize(), c.allocator()),
         cepstrumF0(get<kFFT>().maxFrameSize(), c.allocator()),
+        yinFFT(get<kFFT>().maxFrameSize(), c.allocator()),
         mMagnitude(get<kFFT>().maxFrameSize(), c.allocator()),
         mDescriptors(2, c.allocator())
   {
@@ -100,6 +101,7 @@ public:
     if (mParamTracker.changed(get<kFFT>().frameSize(), sampleRate(), c.hostVectorSize()))
     {
       cepstrumF0.init(get<kFFT>().frameSize(), c.allocator());
+      yinFFT.init(get<kFFT>().frameSize());
       mSTFTBufferedProcess = STFTBufferedProcess(get<kFFT>(), 1, 0, c.hostVectorSize(), c.allocator());
 //      mMagnitude.resize(get<kFFT>().frameSize());
     }
@@ -107,7 +109,7 @@ public:
     FluidTensorView<double, 1> mags = mMagnitude(Slice(0,get<kFFT>().frameSize()));
             
     mSTFTBufferedProcess.processInput(
-        get<kFFT>(), input, c, [&](ComplexMatrixView in) {
+        get<kFFT>(), input, c, [&](ConstComplexMatrixView in) {
           algorithm::STFT::magnitude(in.row(0), mags);
           switch (get<kAlgorithm>())
           {
@@ -156,8 +158,9 @@ public:
 
   void  reset(FluidContext& c)
   {
-    mSTFTBufferedProcess.reset();
+    mSTFTBufferedProcess.reset(c, get<kFFT>());
     cepstrumF0.init(get<kFFT>().frameSize(), c.allocator());
+    yinFFT.init(get<kFFT>().frameSize());
 //    mMagnitude.resize(get<kFFT>().frameSize());
   }
 
@@ -107,7 +107,7 @@ public:
     auto mags = mMags(Slice(0, nPeaks));
 
     mSTFTBufferedProcess.processInput(
-        get<kFFT>(), input, c, [&](ComplexMatrixView in) {
+        get<kFFT>(), input, c, [&](ConstComplexMatrixView in) {
           mNumPeaks = mSineFeature.processFrame(
               in.row(0), peaks, mags, sampleRate(), get<kDetectionThreshold>(),
               get<kSortBy>(), c.allocator());
@@ -147,9 +147,9 @@ public:
 
   index latency() { return get<kFFT>().winSize(); }
   
-  void  reset(FluidContext&)
+  void  reset(FluidContext& c)
   {
-    mSTFTBufferedProcess.reset();
+    mSTFTBufferedProcess.reset(c, get<kFFT>());
     mSineFeature.init(get<kFFT>().winSize(), get<kFFT>().fftSize());
   }
 
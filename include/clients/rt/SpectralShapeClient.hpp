@@ -103,7 +103,7 @@ public:
     }
 
     mSTFTBufferedProcess.processInput(
-        get<kFFT>(), input, c, [&](ComplexMatrixView in) {
+        get<kFFT>(), input, c, [&](ConstComplexMatrixView in) {
           algorithm::STFT::magnitude(in.row(0),
                                      mMagnitude(Slice(0, in.size())));
           mAlgorithm.processFrame(
@@ -128,7 +128,7 @@ public:
 
   index latency() { return get<kFFT>().winSize(); }
 
-  void reset(FluidContext&) { mSTFTBufferedProcess.reset(); }
+  void reset(FluidContext& c) { mSTFTBufferedProcess.reset(c, get<kFFT>()); }
 
   AnalysisSize analysisSettings()
   {
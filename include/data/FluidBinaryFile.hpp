@@ -0,0 +1,356 @@
+/*
+Part of the Fluid Corpus Manipulation Project (http://www.flucoma.org/)
+Copyright 2017-2019 University of Huddersfield.
+Licensed under the BSD-3 License.
+See license.md file in the project root for full license information.
+This project has received funding from the European Research Council (ERC)
+under the European Union’s Horizon 2020 research and innovation programme
+(grant agreement No 725899).
+*/
+
+#pragma once
+
+#include "FluidDataSet.hpp"
+#include "FluidIndex.hpp"
+#include "FluidTensor.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fluid {
+
+/// Compact binary container for FluidDataSet, as an alternative to JSON for
+/// large corpora. Layout (native byte order, checked on load):
+///   header     64 bytes, see BinaryDataSetHeader
+///   data       rows x cols float64 or float32, row-major, 64-byte aligned
+///   id offsets (rows + 1) x uint64, byte offsets into the id blob
+///   id blob    concatenated UTF-8 ids, no terminators
+/// Files are memory mapped on read, so data() and id() are views straight
+/// into the file with no parsing.
+
+struct BinaryDataSetHeader
+{
+  static constexpr char          magic[8] = {'F', 'L', 'U', 'C',
+                                    'O', 'M', 'A', 'D'};
+  static constexpr std::uint32_t byteOrderMark = 0x01020304;
+  static constexpr std::uint32_t currentVersion = 1;
+  enum DataType : std::uint32_t { kFloat64 = 0, kFloat32 = 1 };
+
+  char          tag[8];
+  std::uint32_t byteOrder;
+  std::uint32_t version;
+  std::uint32_t dataType;
+  std::uint32_t reserved;
+  std::uint64_t rows;
+  std::uint64_t cols;
+  std::uint64_t dataOffset;
+  std::uint64_t idsOffset;
+  std::uint64_t idsSize;
+};
+
+static_assert(sizeof(BinaryDataSetHeader) == 64,
+              "Binary DataSet header must be 64 bytes");
+
+namespace impl {
+
+/// read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile() { close(); }
+
+  bool open(const std::string& fileName)
+  {
+    close();
+#ifdef _WIN32
+    mFile = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mFile == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mFile, &size) || size.QuadPart == 0) return false;
+    mSize = static_cast<std::size_t>(size.QuadPart);
+    mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mMapping) return false;
+    mData = MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+    return mData != nullptr;
+#else
+    mFile = ::open(fileName.c_str(), O_RDONLY);
+    if (mFile < 0) return false;
+    struct stat info;
+    if (fstat(mFile, &info) != 0 || info.st_size == 0) return false;
+    mSize = static_cast<std::size_t>(info.st_size);
+    void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFile, 0);
+    if (data == MAP_FAILED) return false;
+    mData = data;
+    return true;
+#endif
+  }
+
+  void close()
+  {
+#ifdef _WIN32
+    if (mData) UnmapViewOfFile(mData);
+    if (mMapping) CloseHandle(mMapping);
+    if (mFile != INVALID_HANDLE_VALUE) CloseHandle(mFile);
+    mMapping = nullptr;
+    mFile = INVALID_HANDLE_VALUE;
+#else
+    if (mData) munmap(mData, mSize);
+    if (mFile >= 0) ::close(mFile);
+    mFile = -1;
+#endif
+    mData = nullptr;
+    mSize = 0;
+  }
+
+  const char* data() const { return static_cast<const char*>(mData); }
+  std::size_t size() const { return mSize; }
+
+private:
+  void*       mData{nullptr};
+  std::size_t mSize{0};
+#ifdef _WIN32
+  HANDLE mFile{INVALID_HANDLE_VALUE};
+  HANDLE mMapping{nullptr};
+#else
+  int mFile{-1};
+#endif
+};
+
+} // namespace impl
+
+class BinaryDataSetFile
+{
+public:
+  using string = std::string;
+  using Header = BinaryDataSetHeader;
+  using DataSet = FluidDataSet<string, double, 1>;
+
+  BinaryDataSetFile(string fileName, string rw) : mFileName(fileName)
+  {
+    assert(rw == "r" || rw == "w");
+    if (fileName.empty())
+      mError = "Filename not specified";
+    else if (rw == "r")
+      openRead();
+    else if (rw != "w")
+      mError = "Invalid read/write specifier";
+  }
+
+  string error() const { return mError; }
+  bool   ok() const { return mError.empty(); }
+
+  bool write(const DataSet& ds, bool singlePrecision = false)
+  {
+    if (!ok()) return false;
+    std::ofstream file(mFileName, std::ios::out | std::ios::binary);
+    if (file.fail())
+    {
+      mError = "Could not open file for writing";
+      return false;
+    }
+
+    auto          ids = ds.getIds();
+    auto          data = ds.getData();
+    std::uint64_t rows = asUnsigned(ds.size());
+    std::uint64_t cols = asUnsigned(ds.pointSize());
+    std::uint64_t elementSize = singlePrecision ? sizeof(float) : sizeof(double);
+
+    Header header{};
+    std::copy_n(Header::magic, 8, header.tag);
+    header.byteOrder = Header::byteOrderMark;
+    header.version = Header::currentVersion;
+    header.dataType = singlePrecision ? Header::kFloat32 : Header::kFloat64;
+    header.rows = rows;
+    header.cols = cols;
+    header.dataOffset = sizeof(Header);
+    header.idsOffset = align(header.dataOffset + rows * cols * elementSize);
+    header.idsSize = 0;
+    std::vector<std::uint64_t> offsets(rows + 1, 0);
+    for (index i = 0; i < ds.size(); i++)
+      offsets[asUnsigned(i) + 1] = offsets[asUnsigned(i)] + ids(i).size();
+    header.idsSize = (rows + 1) * sizeof(std::uint64_t) + offsets.back();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    std::vector<float> floatRow(singlePrecision ? cols : 0);
+    for (index i = 0; i < ds.size(); i++)
+    {
+      auto row = data.row(i);
+      if (singlePrecision)
+      {
+        std::transform(row.begin(), row.end(), floatRow.begin(),
+                       [](double x) { return static_cast<float>(x); });
+        file.write(reinterpret_cast<const char*>(floatRow.data()),
+                   asSigned(cols * sizeof(float)));
+      }
+      else
+      {
+        file.write(reinterpret_cast<const char*>(row.data()),
+                   asSigned(cols * sizeof(double)));
+      }
+    }
+    std::uint64_t padding =
+        header.idsOffset - header.dataOffset - rows * cols * elementSize;
+    std::fill_n(std::ostreambuf_iterator<char>(file), padding, '\0');
+    file.write(reinterpret_cast<const char*>(offsets.data()),
+               asSigned(offsets.size() * sizeof(std::uint64_t)));
+    for (index i = 0; i < ds.size(); i++)
+      file.write(ids(i).data(), asSigned(ids(i).size()));
+
+    if (!file.good()) mError = "Error writing file";
+    return ok();
+  }
+
+  /// copy the mapped file into a FluidDataSet
+  DataSet read() const
+  {
+    if (!ok()) return DataSet();
+    FluidTensor<string, 1> ids(size());
+    for (index i = 0; i < size(); i++) ids(i) = string(id(i));
+    if (singlePrecision())
+      return DataSet(ids, dataFloat());
+    else
+      return DataSet(FluidTensorView<const string, 1>(ids), data());
+  }
+
+  index size() const { return ok() ? asSigned(mHeader.rows) : 0; }
+  index dims() const { return ok() ? asSigned(mHeader.cols) : 0; }
+  bool  singlePrecision() const { return mHeader.dataType == Header::kFloat32; }
+
+  /// zero-copy views into the mapping; only valid while this object lives
+  FluidTensorView<const double, 2> data() const
+  {
+    assert(!singlePrecision());
+    return {reinterpret_cast<const double*>(mMap.data() + mHeader.dataOffset),
+            0, size(), dims()};
+  }
+
+  FluidTensorView<const float, 2> dataFloat() const
+  {
+    assert(singlePrecision());
+    return {reinterpret_cast<const float*>(mMap.data() + mHeader.dataOffset),
+            0, size(), dims()};
+  }
+
+  std::string_view id(index i) const
+  {
+    auto offsets = reinterpret_cast<const std::uint64_t*>(mMap.data() +
+                                                          mHeader.idsOffset);
+    auto blob = mMap.data() + mHeader.idsOffset +
+                (mHeader.rows + 1) * sizeof(std::uint64_t);
+    return {blob + offsets[i], offsets[i + 1] - offsets[i]};
+  }
+
+private:
+  static std::uint64_t align(std::uint64_t offset)
+  {
+    return (offset + 63) & ~std::uint64_t(63);
+  }
+
+  void openRead()
+  {
+    if (!mMap.open(mFileName))
+    {
+      mError = "File not found";
+      return;
+    }
+    if (mMap.size() < sizeof(Header))
+    {
+      mError = "Invalid file format";
+      return;
+    }
+    std::memcpy(&mHeader, mMap.data(), sizeof(Header));
+    if (!std::equal(mHeader.tag, mHeader.tag + 8, Header::magic) ||
+        mHeader.version != Header::currentVersion)
+    {
+      mError = "Invalid file format";
+      return;
+    }
+    if (mHeader.byteOrder != Header::byteOrderMark)
+    {
+      mError = "File was written with a different byte order";
+      return;
+    }
+    // every bound is checked before it is used in an addition or product,
+    // so that a corrupt or crafted header can't wrap around into range
+    std::uint64_t fileSize = mMap.size();
+    auto          fitsIn = [fileSize](std::uint64_t offset, std::uint64_t size) {
+      return offset <= fileSize && size <= fileSize - offset;
+    };
+    std::uint64_t elementSize =
+        singlePrecision() ? sizeof(float) : sizeof(double);
+    bool fits =
+        mHeader.dataType <= Header::kFloat32 &&
+        mHeader.dataOffset >= sizeof(Header) && mHeader.dataOffset % 64 == 0 &&
+        mHeader.idsOffset % 8 == 0 &&
+        mHeader.rows < fileSize / sizeof(std::uint64_t) &&
+        mHeader.cols <=
+            static_cast<std::uint64_t>(std::numeric_limits<index>::max()) &&
+        (mHeader.cols == 0 ||
+         mHeader.rows <= fileSize / elementSize / mHeader.cols);
+    // rows is now small enough that neither size below can overflow
+    std::uint64_t dataSize = mHeader.rows * mHeader.cols * elementSize;
+    std::uint64_t offsetsSize = (mHeader.rows + 1) * sizeof(std::uint64_t);
+    fits = fits && fitsIn(mHeader.dataOffset, dataSize) &&
+           mHeader.dataOffset + dataSize <= mHeader.idsOffset &&
+           fitsIn(mHeader.idsOffset, mHeader.idsSize) &&
+           mHeader.idsSize >= offsetsSize;
+    if (!fits)
+    {
+      mError = "Invalid file format";
+      return;
+    }
+    auto offsets = reinterpret_cast<const std::uint64_t*>(mMap.data() +
+                                                          mHeader.idsOffset);
+    for (std::uint64_t i = 0; i < mHeader.rows; i++)
+    {
+      if (offsets[i] > offsets[i + 1] ||
+          offsets[i + 1] > mHeader.idsSize - offsetsSize)
+      {
+        mError = "Invalid file format";
+        return;
+      }
+    }
+    // FluidDataSet indexes points by id, so a repeated id can't be read
+    std::unordered_set<std::string_view> ids;
+    ids.reserve(mHeader.rows);
+    for (index i = 0; i < asSigned(mHeader.rows); i++)
+    {
+      if (!ids.insert(id(i)).second)
+      {
+        mError = "File contains duplicate ids";
+        return;
+      }
+    }
+  }
+
+  string           mFileName;
+  string           mError;
+  Header           mHeader{};
+  impl::MappedFile mMap;
+};
+
+} // namespace fluid
@@ -3,6 +3,7 @@
 #include "data/FluidIndex.hpp"
 #include "data/FluidTensor.hpp"
 #include "data/TensorTypes.hpp"
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <string>
@@ -111,22 +112,62 @@ public:
     return true;
   }
 
+  // Adds every point whose id isn't already present, growing storage once
+  // for the whole batch. Returns the number of points added, or 0 without
+  // adding anything if points doesn't match ids or this dataset's shape
+  index addPoints(FluidTensorView<const idType, 1>       ids,
+                  FluidTensorView<const dataType, N + 1> points)
+  {
+    auto extents = points.descriptor().extents;
+    if (ids.rows() != points.rows() ||
+        !std::equal(mDim.extents.begin(), mDim.extents.end(),
+                    extents.begin() + 1))
+      return 0;
+    index start = mData.rows();
+    index count = 0;
+    mData.resizeDim(0, ids.rows());
+    mIds.resizeDim(0, ids.rows());
+    for (index i = 0; i < ids.rows(); i++)
+    {
+      index pos = start + count;
+      if (!mIndex.insert({ids(i), pos}).second) continue;
+      mData.row(pos) <<= points.row(i);
+      mIds(pos) = ids(i);
+      count++;
+    }
+    mData.resizeDim(0, count - ids.rows());
+    mIds.resizeDim(0, count - ids.rows());
+    return count;
+  }
+
+  // O(1) in the size of the dataset: the last point is moved into the gap,
+  // so removal doesn't preserve the order of the remaining points
   bool remove(idType const& id)
   {
     auto pos = mIndex.find(id);
-    if (pos == mIndex.end()) { return false; }
-    else
+    if (pos == mIndex.end()) return false;
+    index current = pos->second;
+    index last = mData.rows() - 1;
+    mIndex.erase(pos);
+    if (current != last)
     {
-      auto current = pos->second;
-      mData.deleteRow(current);
-      mIds.deleteRow(current);
-      mIndex.erase(id);
-      for (auto& point : mIndex)
-        if (point.second > current) point.second--;
+      mData.row(current) <<= mData.row(last);
+      mIds(current) = std::move(mIds(last));
+      mIndex[mIds(current)] = current;
     }
+    mData.resizeDim(0, -1);
+    mIds.resizeDim(0, -1);
     return true;
   }
 
+  // Returns the number of points removed
+  index removePoints(FluidTensorView<const idType, 1> ids)
+  {
+    index count = 0;
+    for (index i = 0; i < ids.rows(); i++) count += remove(ids(i));
+    return count;
+  }
+
   FluidTensorView<dataType, N + 1> getData() const { return mData; }
   FluidTensorView<idType, 1>       getIds() const { return mIds; }
   index                            pointSize() const { return mDim.size; }
@@ -133,6 +133,208 @@ void from_json(const nlohmann::json &j, FluidDataSet<std::string, T, 1> &ds) {
   }
 }
 
+// Streaming (de)serialisation of FluidDataSet, for files too big to hold as
+// a DOM. Same schema as to_json / from_json above.
+
+namespace impl {
+
+// SAX handler filling a FluidDataSet one row at a time, so peak memory is the
+// dataset plus a single row
+template <typename T>
+class DataSetSAX : public nlohmann::json_sax<nlohmann::json>
+{
+public:
+  using DataSet = FluidDataSet<std::string, T, 1>;
+
+  DataSetSAX(DataSet& ds) : mDataSet(ds) {}
+
+  bool null() override { return scalar(); }
+  bool boolean(bool) override { return scalar(); }
+  bool binary(binary_t&) override { return scalar(); }
+  bool number_integer(number_integer_t x) override { return number(x); }
+  bool number_unsigned(number_unsigned_t x) override { return number(x); }
+  bool number_float(number_float_t x, const string_t&) override
+  {
+    return number(x);
+  }
+
+  bool string(string_t& x) override
+  {
+    if (mSkip || mState != State::kRow) return scalar();
+    if constexpr (std::is_same<T, std::string>::value)
+    {
+      mRow.push_back(x);
+      return true;
+    }
+    else
+      return false;
+  }
+
+  bool start_object(std::size_t) override
+  {
+    if (mSkip) return ++mSkip;
+    switch (mState)
+    {
+    case State::kStart: mState = State::kTop; return true;
+    case State::kDataKey:
+      mState = State::kData;
+      mHasData = true;
+      return true;
+    case State::kIgnore: return ++mSkip;
+    default: return false;
+    }
+  }
+
+  bool end_object() override
+  {
+    if (mSkip)
+    {
+      if (--mSkip == 0) mState = State::kTop;
+      return true;
+    }
+    mState = mState == State::kData ? State::kTop : State::kEnd;
+    return true;
+  }
+
+  bool key(string_t& x) override
+  {
+    if (mSkip) return true;
+    if (mState == State::kData)
+      mId = x;
+    else if (x == "cols")
+      mState = State::kCols;
+    else if (x == "data")
+      mState = State::kDataKey;
+    else
+      mState = State::kIgnore;
+    return true;
+  }
+
+  bool start_array(std::size_t) override
+  {
+    if (mSkip) return ++mSkip;
+    if (mState == State::kIgnore) return ++mSkip;
+    if (mState != State::kData) return false;
+    mState = State::kRow;
+    mRow.clear();
+    return true;
+  }
+
+  bool end_array() override
+  {
+    if (mSkip)
+    {
+      if (--mSkip == 0) mState = State::kTop;
+      return true;
+    }
+    mState = State::kData;
+    index cols = asSigned(mRow.size());
+    if (mDataSet.size() == 0 && !mHasCols) mDataSet.resize(cols);
+    if (cols != mDataSet.dims()) return false;
+    // a repeated id is malformed rather than silently dropped
+    return mDataSet.add(mId, FluidTensorView<T, 1>(mRow.data(), 0, cols));
+  }
+
+  bool parse_error(std::size_t, const std::string&,
+                   const nlohmann::detail::exception&) override
+  {
+    return false;
+  }
+
+  bool valid() const { return mState == State::kEnd && mHasCols && mHasData; }
+
+private:
+  enum class State { kStart, kTop, kCols, kDataKey, kIgnore, kData, kRow, kEnd };
+
+  template <typename U>
+  bool number(U x)
+  {
+    if (mSkip) return true;
+    if (mState == State::kCols)
+    {
+      index cols = static_cast<index>(x);
+      if (cols < 0 || (mDataSet.size() > 0 && cols != mDataSet.dims()))
+        return false;
+      if (mDataSet.size() == 0) mDataSet.resize(cols);
+      mHasCols = true;
+      mState = State::kTop;
+      return true;
+    }
+    if (mState != State::kRow) return scalar();
+    if constexpr (std::is_arithmetic<T>::value)
+    {
+      mRow.push_back(static_cast<T>(x));
+      return true;
+    }
+    else
+      return false;
+  }
+
+  // scalars are only allowed as values of keys outside the schema
+  bool scalar()
+  {
+    if (mSkip) return true;
+    if (mState != State::kIgnore) return false;
+    mState = State::kTop;
+    return true;
+  }
+
+  DataSet&       mDataSet;
+  std::vector<T> mRow;
+  std::string    mId;
+  State          mState{State::kStart};
+  index          mSkip{0};
+  bool           mHasCols{false};
+  bool           mHasData{false};
+};
+
+template <typename T, typename Input>
+bool sax_read_json(Input&& input, FluidDataSet<std::string, T, 1>& ds)
+{
+  FluidDataSet<std::string, T, 1> result;
+  DataSetSAX<T>                    handler(result);
+  bool ok = nlohmann::json::sax_parse(std::forward<Input>(input), &handler);
+  if (!ok || !handler.valid()) return false;
+  ds = std::move(result);
+  return true;
+}
+
+} // namespace impl
+
+template <typename T>
+bool read_json(std::istream& input, FluidDataSet<std::string, T, 1>& ds)
+{
+  return impl::sax_read_json(input, ds);
+}
+
+template <typename T>
+bool read_json(const std::string& input, FluidDataSet<std::string, T, 1>& ds)
+{
+  return impl::sax_read_json(input, ds);
+}
+
+// Writes one row at a time, so only a single row is ever held as JSON
+template <typename T>
+void write_json(std::ostream& output, const FluidDataSet<std::string, T, 1>& ds,
+                bool pretty = true)
+{
+  auto        ids = ds.getIds();
+  auto        data = ds.getData();
+  const char* indent = pretty ? "\n  " : "";
+  const char* rowIndent = pretty ? "\n    " : "";
+  output << "{" << indent << "\"cols\":" << (pretty ? " " : "")
+         << ds.pointSize() << "," << indent << "\"data\":" << (pretty ? " " : "")
+         << "{";
+  for (index r = 0; r < ds.size(); r++)
+  {
+    output << (r ? "," : "") << rowIndent << nlohmann::json(ids(r)).dump()
+           << ":" << (pretty ? " " : "")
+           << nlohmann::json(FluidTensorView<const T, 1>(data.row(r))).dump();
+  }
+  output << (ds.size() && pretty ? indent : "") << "}" << (pretty ? "\n" : "")
+         << "}";
+}
+
 namespace algorithm {
 // KDTree
 void to_json(nlohmann::json &j, const KDTree &tree) {
@@ -520,6 +722,16 @@ public:
     return false;
   }
 
+  template <typename T>
+  bool write(const FluidDataSet<std::string, T, 1> &ds) {
+    if (ok()) {
+      write_json(mFile, ds);
+      mFile << std::endl;
+      return mFile.good();
+    }
+    return false;
+  }
+
   json read() {
     json result;
     if (ok()) {
@@ -530,6 +742,13 @@ public:
     return result;
   }
 
+  template <typename T>
+  bool read(FluidDataSet<std::string, T, 1> &ds) {
+    if (ok() && !read_json(mFile, ds))
+      mError = "Invalid JSON format";
+    return ok();
+  }
+
 private:
   fstream mFile;
   json mData;
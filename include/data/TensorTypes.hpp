@@ -25,6 +25,9 @@ using ComplexMatrixView = FluidTensorView<std::complex<double>, 2>;
 using RealVectorView = FluidTensorView<double, 1>;
 using ComplexVectorView = FluidTensorView<std::complex<double>, 1>;
 
+using ConstComplexMatrixView = FluidTensorView<const std::complex<double>, 2>;
+using ConstComplexVectorView = FluidTensorView<const std::complex<double>, 1>;
+
 using ArrayXXidx = Eigen::Array<fluid::index, Eigen::Dynamic, Eigen::Dynamic>; 
 using ArrayXidx = Eigen::Array<fluid::index, Eigen::Dynamic, 1>; 
 } // namespace fluid
@@ -0,0 +1,83 @@
+#define CATCH_CONFIG_MAIN
+
+#include <algorithms/public/DCT.hpp>
+#include <catch2/catch.hpp>
+#include <data/FluidIndex.hpp>
+#include <data/FluidTensor.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace fluid {
+
+// orthonormal DCT-II coefficient k, summed directly in long double
+double directDCT(const FluidTensor<double, 1>& x, index k)
+{
+  index       N = x.size();
+  long double sum = 0;
+  for (index n = 0; n < N; n++)
+  {
+    // reduce (2n + 1)k modulo the period 4N so the angle stays exact
+    index m = ((2 * n + 1) * k) % (4 * N);
+    sum += x(n) * std::cos(3.141592653589793238462643383279503L * m / (2 * N));
+  }
+  long double scale = k == 0 ? std::sqrt(1.0L / N) : std::sqrt(2.0L / N);
+  return static_cast<double>(scale * sum);
+}
+
+void checkDCT(index N, index K, std::vector<index> coefficients)
+{
+  std::mt19937                     rng(N * 31 + K);
+  std::uniform_real_distribution<> dist(-1, 1);
+  FluidTensor<double, 1>           input(N);
+  input.apply([&](double& x) { x = dist(rng); });
+
+  algorithm::DCT         dct(N, K);
+  FluidTensor<double, 1> output(K);
+  dct.init(N, K);
+  dct.processFrame(input, output);
+
+  for (index k : coefficients)
+    REQUIRE(output(k) == Approx(directDCT(input, k)).margin(1e-10));
+}
+
+TEST_CASE("DCT matches the direct form on both sides of the table limit",
+          "[DCT]")
+{
+  using Size = std::pair<index, index>;
+  auto size = GENERATE(Size{40, 13}, Size{64, 64}, Size{65, 64},
+                       Size{4097, 1}, Size{100, 41}, Size{513, 513},
+                       Size{1025, 20}, Size{4097, 4097});
+  index              N = size.first, K = size.second;
+  std::vector<index> all;
+  for (index k = 0; k < K; k++) all.push_back(k);
+  checkDCT(N, K, all);
+}
+
+TEST_CASE("DCT larger than the biggest FFT is computed in blocks", "[DCT]")
+{
+  // a 65536 point spectrum: the chirp convolution would need a 131072 FFT
+  index N = 32769;
+  checkDCT(N, N, {0, 1, 2, 1000, 32766, 32767, 32768});
+  checkDCT(N, 40000 - N, {0, 7230});
+}
+
+TEST_CASE("DCT sized for a larger transform runs smaller ones", "[DCT]")
+{
+  algorithm::DCT dct(32769, 32769);
+  for (auto size : {std::pair<index, index>{32769, 32769}, {40, 13},
+                    {513, 513}, {4097, 100}})
+  {
+    index                            N = size.first, K = size.second;
+    std::mt19937                     rng(3);
+    std::uniform_real_distribution<> dist(-1, 1);
+    FluidTensor<double, 1>           input(N), output(K);
+    input.apply([&](double& x) { x = dist(rng); });
+    dct.init(N, K);
+    dct.processFrame(input, output);
+    for (index k : {index(0), K / 2, K - 1})
+      REQUIRE(output(k) == Approx(directDCT(input, k)).margin(1e-10));
+  }
+}
+
+} // namespace fluid
@@ -0,0 +1,74 @@
+#define CATCH_CONFIG_MAIN
+
+#include <algorithms/public/LoudnessMeter.hpp>
+#include <catch2/catch.hpp>
+#include <data/FluidIndex.hpp>
+#include <data/FluidTensor.hpp>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace fluid {
+
+constexpr double sampleRate = 48000;
+
+// consecutive sine segments of (seconds, dBFS), the same on every channel
+FluidTensor<double, 2> sines(index channels, double freq,
+                             std::vector<std::pair<double, double>> segments)
+{
+  index length = 0;
+  for (auto& s : segments) length += std::lrint(s.first * sampleRate);
+  FluidTensor<double, 2> signal(channels, length);
+  index                  pos = 0;
+  for (auto& s : segments)
+  {
+    double gain = std::pow(10, s.second / 20);
+    for (index end = pos + std::lrint(s.first * sampleRate); pos < end; pos++)
+      for (index c = 0; c < channels; c++)
+        signal(c, pos) = gain * std::sin(2 * M_PI * freq * pos / sampleRate);
+  }
+  return signal;
+}
+
+algorithm::LoudnessMeter measure(const FluidTensor<double, 2>& signal)
+{
+  algorithm::LoudnessMeter meter(signal.rows());
+  meter.init(signal.rows(), sampleRate);
+  meter.processBlock(signal);
+  return meter;
+}
+
+TEST_CASE("LoudnessMeter reads a full scale 997Hz sine as -3.01 LUFS",
+          "[LoudnessMeter]")
+{
+  // BS.1770-4: a 0dBFS 997Hz sine on one channel reads -3.01 LKFS
+  auto meter = measure(sines(1, 997, {{10, 0}}));
+  CHECK(meter.integrated() == Approx(-3.01).margin(0.05));
+  CHECK(meter.momentary() == Approx(-3.01).margin(0.05));
+  CHECK(meter.shortTerm() == Approx(-3.01).margin(0.05));
+  CHECK(meter.range() == Approx(0).margin(0.1));
+}
+
+TEST_CASE("LoudnessMeter gates quiet passages out of integrated loudness",
+          "[LoudnessMeter]")
+{
+  // EBU Tech 3341 cases 1 and 3: stereo 1kHz sines, -23 LUFS with or
+  // without 10s at -36dBFS either side, which the relative gate removes
+  auto segments = GENERATE(
+      std::vector<std::pair<double, double>>{{20, -23}},
+      std::vector<std::pair<double, double>>{{10, -36}, {60, -23}, {10, -36}});
+  auto meter = measure(sines(2, 1000, segments));
+  CHECK(meter.integrated() == Approx(-23).margin(0.1));
+}
+
+TEST_CASE("LoudnessMeter measures loudness range", "[LoudnessMeter]")
+{
+  // EBU Tech 3342 cases 1 and 2: stereo 1kHz sines, 20s at each level
+  using Case = std::pair<std::vector<std::pair<double, double>>, double>;
+  auto test = GENERATE(Case{{{20, -20}, {20, -30}}, 10},
+                       Case{{{20, -20}, {20, -15}}, 5});
+  auto meter = measure(sines(2, 1000, test.first));
+  CHECK(meter.range() == Approx(test.second).margin(1));
+}
+
+} // namespace fluid
@@ -0,0 +1,46 @@
+#define CATCH_CONFIG_MAIN
+
+#include <algorithms/public/MDS.hpp>
+#include <algorithms/util/DistanceFuncs.hpp>
+#include <catch2/catch.hpp>
+#include <data/FluidIndex.hpp>
+#include <data/FluidTensor.hpp>
+#include <random>
+
+namespace fluid {
+
+FluidTensor<double, 2> randomPoints(index n, index dims)
+{
+  std::mt19937                     rng(42);
+  std::uniform_real_distribution<> dist(-1, 1);
+  FluidTensor<double, 2>           points(n, dims);
+  points.apply([&](double& x) { x = dist(rng); });
+  return points;
+}
+
+TEST_CASE("Landmark MDS with every point as a landmark matches exact MDS",
+          "[MDS]")
+{
+  using Distance = algorithm::DistanceFuncs::Distance;
+  auto distance = GENERATE(index(Distance::kEuclidean),
+                           index(Distance::kSqEuclidean));
+  index n = 60, k = 3;
+  auto  points = randomPoints(n, 5);
+
+  algorithm::MDS         mds;
+  FluidTensor<double, 2> exact(n, k);
+  FluidTensor<double, 2> landmark(n, k);
+  mds.process(points, exact, distance, k);
+  mds.processLandmarks(points, landmark, distance, k, n);
+
+  // each axis is only defined up to its sign
+  for (index j = 0; j < k; j++)
+  {
+    double sign = exact(0, j) * landmark(0, j) < 0 ? -1 : 1;
+    for (index i = 0; i < n; i++)
+      REQUIRE(landmark(i, j) * sign ==
+              Approx(exact(i, j)).margin(1e-9));
+  }
+}
+
+} // namespace fluid
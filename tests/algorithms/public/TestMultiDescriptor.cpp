@@ -0,0 +1,108 @@
+#define CATCH_CONFIG_MAIN
+
+#include <algorithms/public/DCT.hpp>
+#include <algorithms/public/Loudness.hpp>
+#include <algorithms/public/MelBands.hpp>
+#include <algorithms/public/MultiDescriptor.hpp>
+#include <algorithms/public/STFT.hpp>
+#include <algorithms/public/SpectralShape.hpp>
+#include <algorithms/public/YINFFT.hpp>
+#include <catch2/catch.hpp>
+#include <data/FluidIndex.hpp>
+#include <data/FluidMemory.hpp>
+#include <data/FluidTensor.hpp>
+#include <cmath>
+#include <complex>
+
+namespace fluid {
+
+TEST_CASE("MultiDescriptor columns match the individual descriptors",
+          "[MultiDescriptor]")
+{
+  using namespace algorithm;
+
+  bool   usePower = GENERATE(false, true);
+  index  windowSize = 1024, fftSize = 2048, nBands = 40, nCoefs = 13;
+  index  nBins = fftSize / 2 + 1;
+  double sampleRate = 44100, minFreq = 20, maxFreq = 20000;
+  double pitchMin = 50, pitchMax = 5000;
+  auto&  alloc = FluidDefaultAllocator();
+
+  FluidTensor<double, 1> window(windowSize);
+  for (index i = 0; i < windowSize; i++)
+    window(i) = 0.5 * std::sin(2 * M_PI * 220 * i / sampleRate) +
+                0.25 * std::sin(2 * M_PI * 1330 * i / sampleRate);
+
+  MultiDescriptor multi(fftSize, nBands, nCoefs);
+  multi.init(windowSize, fftSize, nBands, nCoefs, sampleRate);
+  FluidTensor<double, 1> packed(MultiDescriptor::size(nBands, nCoefs));
+  multi.processFrame(window, packed, minFreq, maxFreq, pitchMin, pitchMax,
+                     usePower, true, true, alloc);
+
+  // the same chain, run descriptor by descriptor
+  STFT stft(windowSize, fftSize, windowSize);
+  FluidTensor<std::complex<double>, 1> spectrum(nBins);
+  FluidTensor<double, 1>               magnitude(nBins);
+  stft.processFrame(window, spectrum);
+  STFT::magnitude(spectrum, magnitude);
+
+  FluidTensor<double, 1> bands(nBands);
+  FluidTensor<double, 1> melInput(magnitude);
+  MelBands               melBands(nBands, fftSize);
+  melBands.init(minFreq, maxFreq, nBands, nBins, sampleRate, windowSize);
+  melBands.processFrame(melInput, bands, false, usePower, true, alloc);
+
+  FluidTensor<double, 1> coefs(nCoefs);
+  DCT                    dct(nBands, nCoefs);
+  dct.init(nBands, nCoefs);
+  dct.processFrame(bands, coefs);
+
+  FluidTensor<double, 1> shape(MultiDescriptor::shapeSize);
+  SpectralShape          spectralShape(alloc);
+  spectralShape.processFrame(magnitude, shape, sampleRate, minFreq, maxFreq,
+                             95, false, usePower, alloc);
+
+  FluidTensor<double, 1> pitch(MultiDescriptor::pitchSize);
+  YINFFT                 yin(nBins);
+  yin.init(nBins);
+  yin.processFrame(magnitude, pitch, pitchMin, pitchMax, sampleRate);
+
+  FluidTensor<double, 1> loudness(MultiDescriptor::loudnessSize);
+  Loudness               loudnessMeter(windowSize);
+  loudnessMeter.init(windowSize, sampleRate);
+  loudnessMeter.processFrame(window, loudness, true, true);
+
+  index offset = 0;
+  auto  checkBlock = [&](const FluidTensor<double, 1>& expected) {
+    for (index i = 0; i < expected.size(); i++)
+      REQUIRE(packed(offset + i) ==
+              Approx(expected(i)).epsilon(1e-9).margin(1e-9));
+    offset += expected.size();
+  };
+
+  SECTION("mel bands") { checkBlock(bands); }
+  SECTION("mfccs")
+  {
+    offset = nBands;
+    checkBlock(coefs);
+  }
+  SECTION("spectral shape")
+  {
+    offset = nBands + nCoefs;
+    checkBlock(shape);
+  }
+  SECTION("pitch")
+  {
+    offset = nBands + nCoefs + MultiDescriptor::shapeSize;
+    checkBlock(pitch);
+  }
+  SECTION("loudness")
+  {
+    offset = nBands + nCoefs + MultiDescriptor::shapeSize +
+             MultiDescriptor::pitchSize;
+    checkBlock(loudness);
+    CHECK(offset == packed.size());
+  }
+}
+
+} // namespace fluid
@@ -0,0 +1,110 @@
+#define CATCH_CONFIG_MAIN
+
+#include <algorithms/public/NMF.hpp>
+#include <catch2/catch.hpp>
+#include <data/FluidIndex.hpp>
+#include <data/FluidTensor.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace fluid {
+
+FluidTensor<double, 2> randomPositive(index rows, index cols, unsigned seed)
+{
+  std::mt19937                     rng(seed);
+  std::uniform_real_distribution<> dist(0.05, 1);
+  FluidTensor<double, 2>           m(rows, cols);
+  m.apply([&](double& x) { x = dist(rng); });
+  return m;
+}
+
+// frames x bins from a rank 3 model plus some noise
+FluidTensor<double, 2> testSpectrogram(index frames, index bins)
+{
+  auto                   W = randomPositive(3, bins, 1);
+  auto                   H = randomPositive(frames, 3, 2);
+  auto                   noise = randomPositive(frames, bins, 3);
+  FluidTensor<double, 2> X(frames, bins);
+  for (index i = 0; i < frames; i++)
+    for (index j = 0; j < bins; j++)
+    {
+      X(i, j) = 0.1 * noise(i, j);
+      for (index k = 0; k < 3; k++) X(i, j) += H(i, k) * W(k, j);
+    }
+  return X;
+}
+
+double divergence(const FluidTensor<double, 2>& X,
+                  const FluidTensor<double, 2>& model, index beta)
+{
+  double d = 0;
+  for (index i = 0; i < X.rows(); i++)
+    for (index j = 0; j < X.cols(); j++)
+    {
+      double x = X(i, j), y = model(i, j);
+      switch (beta)
+      {
+      case 0: d += x / y - std::log(x / y) - 1; break;
+      case 1: d += x * std::log(x / y) - x + y; break;
+      default: d += 0.5 * (x - y) * (x - y);
+      }
+    }
+  return d;
+}
+
+struct Result
+{
+  FluidTensor<double, 2> model;
+  index                  iterations;
+};
+
+Result factorise(FluidTensor<double, 2> X, index rank, index iterations,
+                 index beta, double tolerance = 0)
+{
+  index                  frames = X.rows(), bins = X.cols();
+  auto                   W0 = randomPositive(rank, bins, 4);
+  auto                   H0 = randomPositive(frames, rank, 5);
+  FluidTensor<double, 2> W(rank, bins), H(frames, rank), V(frames, bins);
+  algorithm::NMF         nmf;
+  index                  ran = 0;
+  nmf.addProgressCallback([&](index i) {
+    ran = i;
+    return true;
+  });
+  nmf.process(X, W, H, V, rank, iterations, true, true, W0, H0, beta,
+              tolerance);
+  return {V, ran};
+}
+
+TEST_CASE("NMF divergence decreases every iteration for each beta", "[NMF]")
+{
+  index beta = GENERATE(0, 1, 2);
+  auto  X = testSpectrogram(40, 30);
+
+  double previous = divergence(X, factorise(X, 3, 1, beta).model, beta);
+  for (index n = 2; n <= 30; n++)
+  {
+    double current = divergence(X, factorise(X, 3, n, beta).model, beta);
+    REQUIRE(current <= previous * (1 + 1e-9));
+    previous = current;
+  }
+}
+
+TEST_CASE("NMF stops early once an iteration improves by less than tolerance",
+          "[NMF]")
+{
+  index beta = GENERATE(0, 1, 2);
+  auto  X = testSpectrogram(40, 30);
+
+  auto full = factorise(X, 3, 500, beta);
+  auto early = factorise(X, 3, 500, beta, 1e-4);
+  CHECK(full.iterations == 500);
+  CHECK(early.iterations < 500);
+  CHECK(early.iterations > 1);
+  // stopping early costs little against running to the end
+  CHECK(divergence(X, early.model, beta) <=
+        1.05 * divergence(X, full.model, beta));
+}
+
+} // namespace fluid
@@ -0,0 +1,125 @@
+#define CATCH_CONFIG_MAIN
+
+#include <algorithms/public/NNDSVD.hpp>
+#include <algorithms/util/FluidEigenMappings.hpp>
+#include <catch2/catch.hpp>
+#include <CatchUtils.hpp>
+#include <data/FluidIndex.hpp>
+#include <data/FluidTensor.hpp>
+#include <Eigen/SVD>
+#include <cmath>
+#include <random>
+
+namespace fluid {
+
+// frames x bins, the sum of rank nonnegative outer products
+FluidTensor<double, 2> lowRank(index frames, index bins, index rank)
+{
+  std::mt19937                     rng(7);
+  std::uniform_real_distribution<> dist(0, 1);
+  Eigen::MatrixXd                  H(frames, rank), W(rank, bins);
+  for (index i = 0; i < H.size(); i++) H.data()[i] = dist(rng);
+  for (index i = 0; i < W.size(); i++) W.data()[i] = dist(rng) / (1 + i % rank);
+  Eigen::MatrixXd        X = H * W;
+  FluidTensor<double, 2> out(frames, bins);
+  algorithm::_impl::asEigen<Eigen::Matrix>(out) = X;
+  return out;
+}
+
+// noise over a decaying spectrum, which has no exact low rank
+FluidTensor<double, 2> noisySpectrogram(index frames, index bins)
+{
+  auto                             X = lowRank(frames, bins, 6);
+  std::mt19937                     rng(8);
+  std::uniform_real_distribution<> dist(0, 0.05);
+  X.apply([&](double& x) { x += dist(rng); });
+  return X;
+}
+
+TEST_CASE("NNDSVD at a fixed rank is repeatable and matches the exact SVD",
+          "[NNDSVD]")
+{
+  // 257 bins takes the subspace iteration for these ranks, 64 the Gram matrix
+  index bins = GENERATE(64, 257);
+  index rank = GENERATE(1, 4, 5);
+  auto  X = noisySpectrogram(400, bins);
+
+  FluidTensor<double, 2> W(rank, bins), H(400, rank);
+  FluidTensor<double, 2> W2(rank, bins), H2(400, rank);
+  algorithm::NNDSVD      nndsvd;
+  REQUIRE(nndsvd.process(X, W, H, rank, rank, 0, 0) == rank);
+  REQUIRE(nndsvd.process(X, W2, H2, rank, rank, 0, 0) == rank);
+  REQUIRE_THAT(W2, EqualsRange(W));
+  REQUIRE_THAT(H2, EqualsRange(H));
+
+  using namespace Eigen;
+  MatrixXd         XT = algorithm::_impl::asEigen<Matrix>(X).transpose();
+  BDCSVD<MatrixXd> svd(XT, ComputeThinU | ComputeThinV);
+  for (index j = 0; j < rank; j++)
+  {
+    VectorXd u = svd.matrixU().col(j).cwiseAbs();
+    VectorXd sv = svd.singularValues()(j) * svd.matrixV().col(j).cwiseAbs();
+    for (index i = 0; i < bins; i++)
+      REQUIRE(W(j, i) == Approx(u(i)).margin(1e-9));
+    for (index i = 0; i < 400; i++)
+      REQUIRE(H(i, j) == Approx(sv(i)).epsilon(1e-9).margin(1e-9));
+  }
+}
+
+TEST_CASE("NNDSVD with fewer frames than bins matches the exact SVD",
+          "[NNDSVD]")
+{
+  // coverage takes the Gram path, which works on the frames here
+  index  frames = 40, bins = 257;
+  double coverage = GENERATE(0.3, 0.6);
+  auto   X = noisySpectrogram(frames, bins);
+
+  using namespace Eigen;
+  MatrixXd         XT = algorithm::_impl::asEigen<Matrix>(X).transpose();
+  BDCSVD<MatrixXd> svd(XT, ComputeThinU | ComputeThinV);
+  VectorXd         s = svd.singularValues();
+  index            expected = 0;
+  for (double current = 0; current / s.sum() < coverage;)
+    current += s(expected++);
+
+  FluidTensor<double, 2> W(frames, bins), H(frames, frames);
+  algorithm::NNDSVD      nndsvd;
+  index k = nndsvd.process(X, W, H, 1, frames, coverage, 0);
+  REQUIRE(k == expected);
+  for (index j = 0; j < k; j++)
+  {
+    VectorXd u = svd.matrixU().col(j).cwiseAbs();
+    VectorXd sv = s(j) * svd.matrixV().col(j).cwiseAbs();
+    for (index i = 0; i < bins; i++)
+      REQUIRE(W(j, i) == Approx(u(i)).margin(1e-9));
+    for (index i = 0; i < frames; i++)
+      REQUIRE(H(i, j) == Approx(sv(i)).epsilon(1e-9).margin(1e-9));
+  }
+}
+
+TEST_CASE("NNDSVD leaves components past the rank of the data empty",
+          "[NNDSVD]")
+{
+  index bins = GENERATE(64, 257);
+  index method = GENERATE(0, 1, 2, 3);
+  index rank = 3, asked = 6;
+  auto  X = lowRank(300, bins, rank);
+
+  FluidTensor<double, 2> W(asked, bins), H(300, asked);
+  algorithm::NNDSVD      nndsvd;
+  REQUIRE(nndsvd.process(X, W, H, asked, asked, 0, method) == asked);
+  for (auto x : W) REQUIRE(std::isfinite(x));
+  for (auto x : H) REQUIRE(std::isfinite(x));
+
+  // NMF-SVD and NNDSVD have nothing to fill them with
+  if (method == 0 || method == 3)
+  {
+    for (index j = rank; j < asked; j++)
+    {
+      for (index i = 0; i < bins; i++) REQUIRE(W(j, i) <= algorithm::epsilon);
+      for (index i = 0; i < 300; i++) REQUIRE(H(i, j) <= algorithm::epsilon);
+    }
+  }
+}
+
+} // namespace fluid
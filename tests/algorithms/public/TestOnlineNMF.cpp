@@ -0,0 +1,133 @@
+#define CATCH_CONFIG_MAIN
+
+#include <algorithms/public/OnlineNMF.hpp>
+#include <catch2/catch.hpp>
+#include <data/FluidIndex.hpp>
+#include <data/FluidTensor.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+namespace fluid {
+
+FluidTensor<double, 2> randomPositive(index rows, index cols, unsigned seed)
+{
+  std::mt19937                     rng(seed);
+  std::uniform_real_distribution<> dist(0.05, 1);
+  FluidTensor<double, 2>           m(rows, cols);
+  m.apply([&](double& x) { x = dist(rng); });
+  return m;
+}
+
+// frames x bins from an exact rank 3 model
+FluidTensor<double, 2> lowRank(index frames, index bins)
+{
+  auto                   W = randomPositive(3, bins, 1);
+  auto                   H = randomPositive(frames, 3, 2);
+  FluidTensor<double, 2> X(frames, bins);
+  for (index i = 0; i < frames; i++)
+    for (index j = 0; j < bins; j++)
+    {
+      X(i, j) = 0;
+      for (index k = 0; k < 3; k++) X(i, j) += H(i, k) * W(k, j);
+    }
+  return X;
+}
+
+double model(const FluidTensor<double, 2>& H, const FluidTensor<double, 2>& W,
+             index i, index j)
+{
+  double y = 0;
+  for (index k = 0; k < W.rows(); k++) y += H(i, k) * W(k, j);
+  return y;
+}
+
+double divergence(const FluidTensor<double, 2>& X,
+                  const FluidTensor<double, 2>& H,
+                  const FluidTensor<double, 2>& W)
+{
+  double d = 0;
+  for (index i = 0; i < X.rows(); i++)
+    for (index j = 0; j < X.cols(); j++)
+    {
+      double x = X(i, j), y = model(H, W, i, j);
+      d += x * std::log(x / y) - x + y;
+    }
+  return d;
+}
+
+TEST_CASE("One OnlineNMF batch from empty statistics is a KL basis update",
+          "[OnlineNMF]")
+{
+  index frames = 20, bins = 16, rank = 3;
+  auto  X = lowRank(frames, bins);
+  auto  W0 = randomPositive(rank, bins, 3);
+  for (index k = 0; k < rank; k++)
+  {
+    double norm = 0;
+    for (index j = 0; j < bins; j++) norm += W0(k, j) * W0(k, j);
+    for (index j = 0; j < bins; j++) W0(k, j) /= std::sqrt(norm);
+  }
+
+  algorithm::OnlineNMF   nmf(bins, rank, frames);
+  FluidTensor<double, 2> H(frames, rank), W(rank, bins);
+  nmf.init(W0);
+  nmf.processBatch(X, H, 1);
+  nmf.getW(W);
+
+  // W *= ((X / WH) H) / sum(H), against the activations of that iteration,
+  // then each basis scaled to unit norm
+  FluidTensor<double, 2> expected(rank, bins);
+  for (index k = 0; k < rank; k++)
+  {
+    double hSum = 0, norm = 0;
+    for (index i = 0; i < frames; i++) hSum += H(i, k);
+    for (index j = 0; j < bins; j++)
+    {
+      double num = 0;
+      for (index i = 0; i < frames; i++)
+        num += X(i, j) / model(H, W0, i, j) * H(i, k);
+      expected(k, j) = W0(k, j) * num / hSum;
+      norm += expected(k, j) * expected(k, j);
+    }
+    for (index j = 0; j < bins; j++) expected(k, j) /= std::sqrt(norm);
+  }
+
+  for (index k = 0; k < rank; k++)
+    for (index j = 0; j < bins; j++)
+      REQUIRE(W(k, j) == Approx(expected(k, j)).margin(1e-12));
+}
+
+TEST_CASE("OnlineNMF divergence does not increase over repeated passes",
+          "[OnlineNMF]")
+{
+  index  frames = 60, bins = 24, rank = 3, batch = 20;
+  double decay = GENERATE(1.0, 0.9);
+  auto   X = lowRank(frames, bins);
+
+  std::srand(11); // activations start from Eigen's Random
+  algorithm::OnlineNMF   nmf(bins, rank, frames);
+  FluidTensor<double, 2> H(frames, rank), W(rank, bins);
+  nmf.init(bins, rank);
+
+  // divergence of the whole input with activations fitted to the bases
+  auto evaluate = [&]() {
+    nmf.processBatch(X, H, 100, false);
+    nmf.getW(W);
+    return divergence(X, H, W);
+  };
+
+  double previous = evaluate();
+  for (index pass = 0; pass < 10; pass++)
+  {
+    for (index start = 0; start < frames; start += batch)
+      nmf.processBatch(X(Slice(start, batch), Slice(0)),
+                       FluidTensorView<double, 2>{nullptr, 0, 0, 0}, 10,
+                       true, decay);
+    double current = evaluate();
+    REQUIRE(current <= previous * (1 + 1e-9));
+    previous = current;
+  }
+}
+
+} // namespace fluid
@@ -0,0 +1,76 @@
+#define CATCH_CONFIG_MAIN
+
+#include <algorithms/util/MedianFilter.hpp>
+#include <catch2/catch.hpp>
+#include <data/FluidIndex.hpp>
+#include <data/FluidMemory.hpp>
+#include <data/FluidTensor.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace fluid {
+
+// reference: sort the window each time
+double bruteMedian(const std::vector<double>& x, index end, index size)
+{
+  std::vector<double> window;
+  for (index i = end - size + 1; i <= end; i++)
+    window.push_back(i >= 0 && i < asSigned(x.size()) ? x[asUnsigned(i)] : 0);
+  std::sort(window.begin(), window.end());
+  return window[asUnsigned(size / 2)];
+}
+
+std::vector<double> testSignal(index length)
+{
+  std::mt19937                     rng(42);
+  std::uniform_int_distribution<> dist(-20, 20);
+  std::vector<double>              x(asUnsigned(length));
+  // integer values so that ties are common
+  std::generate(x.begin(), x.end(), [&] { return dist(rng); });
+  return x;
+}
+
+TEST_CASE("MedianFilter matches a sorted window sample by sample",
+          "[MedianFilter]")
+{
+  auto size = GENERATE(index(3), index(5), index(31), index(101));
+  auto x = testSignal(1000);
+  algorithm::MedianFilter filter(101, FluidDefaultAllocator());
+  filter.init(size);
+  for (index i = 0; i < asSigned(x.size()); i++)
+    REQUIRE(filter.processSample(x[asUnsigned(i)]) == bruteMedian(x, i, size));
+}
+
+TEST_CASE("MedianFilter can shrink and grow between inits", "[MedianFilter]")
+{
+  auto x = testSignal(300);
+  algorithm::MedianFilter filter(51, FluidDefaultAllocator());
+  for (index size : {51, 3, 17, 51})
+  {
+    filter.init(size);
+    for (index i = 0; i < asSigned(x.size()); i++)
+      REQUIRE(filter.processSample(x[asUnsigned(i)]) ==
+              bruteMedian(x, i, size));
+  }
+}
+
+TEST_CASE("MedianFilter filters whole vectors with a given lookahead",
+          "[MedianFilter]")
+{
+  auto size = GENERATE(index(3), index(9), index(101));
+  auto x = testSignal(257);
+  auto lookahead = GENERATE_COPY(index(0), size / 2, size - 1);
+  algorithm::MedianFilter filter(101, FluidDefaultAllocator());
+  filter.init(size);
+  // leave some state behind to check that process() doesn't depend on it
+  for (index i = 0; i < 50; i++) filter.processSample(100);
+
+  FluidTensor<double, 1> out(asSigned(x.size()));
+  filter.process(FluidTensorView<const double, 1>(x.data(), 0, out.size()),
+                 out, lookahead);
+  for (index i = 0; i < out.size(); i++)
+    REQUIRE(out(i) == bruteMedian(x, i + lookahead, size));
+}
+
+} // namespace fluid
@@ -15,7 +15,10 @@ using fluid::FluidTensor;
 using fluid::FluidTensorView;
 using fluid::Slice;
 using fluid::client::BufferedProcess; 
+using fluid::client::FFTParams;
+using fluid::client::STFTBufferedProcess;
 using fluid::client::FluidContext;
+using fluid::client::SharedSTFTRegistry;
 
 TEST_CASE("BufferedProcess will reconstruct windowed input properly under COLA conditions","[BufferedProcess]"){
     
@@ -68,3 +71,55 @@ TEST_CASE("BufferedProcess will reconstruct windowed input properly under COLA c
       
     }
 }
+
+TEST_CASE("STFTBufferedProcess clients reading the same signal can share one "
+          "analysis",
+          "[BufferedProcess]")
+{
+  using fluid::index;
+  constexpr index hostSize = 64;
+  auto            hop = GENERATE(16, 64, 128);
+  FFTParams       fft(256, hop, 512);
+
+  int                key;
+  SharedSTFTRegistry registry(fluid::FluidDefaultAllocator());
+  FluidContext       c(hostSize, fluid::FluidDefaultAllocator());
+  FluidContext       shared(hostSize, fluid::FluidDefaultAllocator());
+  shared.analysisKey(&key, &registry);
+
+  auto make = [&] {
+    return STFTBufferedProcess<false>(fft, 1, 0, hostSize,
+                                      fluid::FluidDefaultAllocator());
+  };
+  auto alone = make(), first = make(), second = make();
+  // subscribing happens on reset, away from the audio thread
+  alone.reset(c, fft);
+  first.reset(shared, fft);
+  second.reset(shared, fft);
+
+  std::vector<double> signal(hostSize * 32);
+  std::generate(signal.begin(), signal.end(),
+                [n = 0]() mutable { return std::sin(0.1 * n++ * n); });
+
+  for (index i = 0; i < fluid::asSigned(signal.size()); i += hostSize)
+  {
+    std::vector<FluidTensorView<double, 1>> input{
+        FluidTensorView<double, 1>(signal.data(), i, hostSize)};
+    std::vector<std::complex<double>>        expected, a, b;
+    std::vector<const std::complex<double>*> framesA, framesB, framesAlone;
+    auto collect = [](std::vector<std::complex<double>>&        v,
+                      std::vector<const std::complex<double>*>& frames) {
+      return [&v, &frames](fluid::ConstComplexMatrixView in) {
+        std::copy(in.begin(), in.end(), std::back_inserter(v));
+        frames.push_back(in.data());
+      };
+    };
+    alone.processInput(fft, input, c, collect(expected, framesAlone));
+    first.processInput(fft, input, shared, collect(a, framesA));
+    second.processInput(fft, input, shared, collect(b, framesB));
+    CHECK(a == expected);
+    CHECK(b == expected);
+    // both were handed the one stored analysis
+    CHECK(framesA == framesB);
+  }
+}
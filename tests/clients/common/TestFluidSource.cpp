@@ -57,3 +57,42 @@ TEMPLATE_TEST_CASE(
     j = j < hostSize ? j : j - hostSize;
   }
 }
+
+TEST_CASE("FluidSource pullView matches pull, copying only when the frame wraps",
+          "[FluidSource][frames]")
+{
+  constexpr int hostSize = 64;
+  constexpr int maxFrameSize = 256;
+  constexpr int channels = 2;
+
+  FluidSource<double> framer(maxFrameSize, channels, hostSize);
+
+  auto frameSize = GENERATE(32, 43, 256);
+  int  hop = frameSize / 2;
+
+  constexpr int          length = 4 * maxFrameSize;
+  std::vector<double>    data(channels * length);
+  FluidTensor<double, 2> expected(channels, frameSize);
+  FluidTensor<double, 2> scratch(channels, frameSize);
+  std::iota(data.begin(), data.end(), 0);
+  FluidTensorView<double, 2> input{data.data(), 0, channels, length};
+
+  bool sawView = false, sawCopy = false;
+  for (int i = 0, j = 0; i + hostSize <= length; i += hostSize)
+  {
+    framer.push(input(Slice(0), Slice(i, hostSize)));
+    for (; j < hostSize; j += hop)
+    {
+      framer.pull(expected, j);
+      auto view = framer.pullView(scratch, j);
+      bool copied = view.data() == scratch.data();
+      sawCopy |= copied;
+      sawView |= !copied;
+      for (int c = 0; c < channels; ++c)
+        CHECK_THAT(view.row(c), EqualsRange(expected.row(c)));
+    }
+    j -= hostSize;
+  }
+  CHECK(sawView);
+  CHECK(sawCopy);
+}
@@ -0,0 +1,116 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <clients/common/ParameterConstraints.hpp>
+#include <clients/common/ParameterSet.hpp>
+#include <clients/common/ParameterTypes.hpp>
+#include <clients/common/ParameterUpdateQueue.hpp>
+#include <clients/rt/GainClient.hpp>
+#include <data/FluidMemory.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace fluid::client;
+using fluid::FluidDefaultAllocator;
+
+namespace {
+auto constexpr testParams =
+    defineParameters(FloatParam("gain", "Gain", 0.0),
+                     LongParam("order", "Order", 1, Min(0), Max(10)),
+                     StringParam("name", "Name"));
+
+using Params = ParameterSet<decltype(testParams)>;
+using Queue = ParameterUpdateQueue<decltype(testParams), 16>;
+} // namespace
+
+TEST_CASE("ParameterUpdateQueue applies coalesced changes with constraints",
+          "[ParameterUpdateQueue]")
+{
+  Params params(testParams, FluidDefaultAllocator());
+  params.keepConstrained(true);
+  Queue queue;
+
+  CHECK_FALSE(queue.apply(params));
+
+  CHECK(queue.push<0>(0.5));
+  CHECK(queue.push<1>(4));
+  CHECK(queue.push<0>(0.75));
+  CHECK(queue.push<1>(42));
+  // nothing changes until the consumer applies the queue
+  CHECK(params.get<0>() == 0.0);
+  CHECK(params.get<1>() == 1);
+
+  CHECK(queue.apply(params));
+  CHECK(queue.empty());
+  CHECK(params.get<0>() == 0.75);
+  CHECK(params.get<1>() == 10);
+}
+
+TEST_CASE("ParameterUpdateQueue refuses changes when full",
+          "[ParameterUpdateQueue]")
+{
+  Params params(testParams, FluidDefaultAllocator());
+  Queue  queue;
+  for (int i = 0; i < 15; ++i) CHECK(queue.push<0>(i));
+  CHECK_FALSE(queue.push<0>(15.0));
+  queue.apply(params);
+  CHECK(params.get<0>() == 14);
+  CHECK(queue.push<0>(15.0));
+}
+
+TEST_CASE("ParameterUpdateQueue passes changes between threads in order",
+          "[ParameterUpdateQueue]")
+{
+  Params            params(testParams, FluidDefaultAllocator());
+  Queue             queue;
+  constexpr int     count = 100000;
+  std::atomic<bool> done{false};
+
+  std::thread producer([&] {
+    for (int i = 1; i <= count; ++i)
+      while (!queue.push<0>(i)) std::this_thread::yield();
+    done = true;
+  });
+
+  double last = 0;
+  bool   ordered = true;
+  while (!done || !queue.empty())
+  {
+    queue.apply(params);
+    ordered &= params.get<0>() >= last;
+    last = params.get<0>();
+  }
+  producer.join();
+  CHECK(ordered);
+  CHECK(params.get<0>() == count);
+}
+
+TEST_CASE("ClientWrapper applies queued changes at the next block",
+          "[ParameterUpdateQueue]")
+{
+  using fluid::FluidTensor;
+  using fluid::FluidTensorView;
+  using Wrapper = RTGainClient;
+  using Views = std::vector<FluidTensorView<double, 1>>;
+
+  FluidContext           c;
+  Wrapper::ParamSetType  params(Wrapper::getParameterDescriptors(),
+                                FluidDefaultAllocator());
+  Wrapper                client(params, c);
+  FluidTensor<double, 1> in(4), out(4);
+  Views                  inputs{in, {nullptr, 0, 0}};
+  Views                  outputs{out};
+  in.fill(1);
+
+  // the queue lives on the heap, so wrappers can go wherever malloc puts them
+  static_assert(alignof(Wrapper) <= alignof(std::max_align_t));
+  client.process(inputs, outputs, c);
+  CHECK(out(0) == 1.0);
+
+  CHECK(client.queue<gain::kGain>(0.5));
+  // nothing changes until the audio thread starts a block
+  CHECK(params.get<gain::kGain>() == 1.0);
+  client.process(inputs, outputs, c);
+  CHECK(params.get<gain::kGain>() == 0.5);
+  CHECK(out(0) == 0.5);
+}
@@ -0,0 +1,162 @@
+#define CATCH_CONFIG_MAIN
+
+#include <catch2/catch.hpp>
+#include <data/FluidBinaryFile.hpp>
+#include <data/FluidIndex.hpp>
+#include <data/FluidTensor.hpp>
+#include <CatchUtils.hpp>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+using fluid::BinaryDataSetFile;
+using fluid::BinaryDataSetHeader;
+using fluid::EqualsRange;
+using fluid::FluidTensor;
+using DataSet = BinaryDataSetFile::DataSet;
+
+namespace {
+
+DataSet testDataSet()
+{
+  FluidTensor<double, 2>      points{{0.5, 1, 2}, {-3, 4.25, 5}, {6, 7, 8}};
+  FluidTensor<std::string, 1> ids{"zero", "", "a longer id"};
+  return DataSet(ids, points);
+}
+
+std::vector<char> readBytes(const std::string& fileName)
+{
+  std::ifstream file(fileName, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file),
+          std::istreambuf_iterator<char>()};
+}
+
+void writeBytes(const std::string& fileName, const std::vector<char>& bytes)
+{
+  std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+  file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// a valid file with its header edited, written alongside the original
+std::string withHeader(void (*edit)(BinaryDataSetHeader&))
+{
+  std::string original = "TestFluidBinaryFile.bin";
+  std::string corrupt = "TestFluidBinaryFile_corrupt.bin";
+  REQUIRE(BinaryDataSetFile(original, "w").write(testDataSet()));
+  auto                bytes = readBytes(original);
+  BinaryDataSetHeader header;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  edit(header);
+  std::memcpy(bytes.data(), &header, sizeof(header));
+  writeBytes(corrupt, bytes);
+  return corrupt;
+}
+
+} // namespace
+
+TEST_CASE("BinaryDataSetFile round trips a DataSet", "[BinaryDataSetFile]")
+{
+  bool        singlePrecision = GENERATE(false, true);
+  std::string fileName = "TestFluidBinaryFile.bin";
+  auto        original = testDataSet();
+
+  REQUIRE(BinaryDataSetFile(fileName, "w").write(original, singlePrecision));
+
+  BinaryDataSetFile file(fileName, "r");
+  REQUIRE(file.ok());
+  CHECK(file.size() == original.size());
+  CHECK(file.dims() == original.dims());
+  CHECK(file.singlePrecision() == singlePrecision);
+
+  auto copy = file.read();
+  REQUIRE(copy.size() == original.size());
+  for (fluid::index i = 0; i < original.size(); i++)
+  {
+    auto id = original.getIds()(i);
+    CHECK(file.id(i) == id);
+    REQUIRE_THAT(copy.get(id), EqualsRange(original.get(id)));
+  }
+}
+
+TEST_CASE("BinaryDataSetFile rejects truncated files", "[BinaryDataSetFile]")
+{
+  std::string original = "TestFluidBinaryFile.bin";
+  std::string corrupt = "TestFluidBinaryFile_corrupt.bin";
+  REQUIRE(BinaryDataSetFile(original, "w").write(testDataSet()));
+  auto bytes = readBytes(original);
+
+  std::size_t length = GENERATE(std::size_t(1), std::size_t(32),
+                                std::size_t(64), std::size_t(100));
+  REQUIRE(length < bytes.size() - 1);
+  bytes.resize(bytes.size() - length);
+  writeBytes(corrupt, bytes);
+  CHECK_FALSE(BinaryDataSetFile(corrupt, "r").ok());
+}
+
+TEST_CASE("BinaryDataSetFile rejects headers that overflow the file",
+          "[BinaryDataSetFile]")
+{
+  using Edit = void (*)(BinaryDataSetHeader&);
+  constexpr auto big = std::numeric_limits<std::uint64_t>::max();
+
+  Edit edit = GENERATE(
+      // (rows + 1) * 8 wraps to 8 when cols is 0
+      Edit([](BinaryDataSetHeader& h) {
+        h.rows = std::uint64_t(1) << 61;
+        h.cols = 0;
+      }),
+      Edit([](BinaryDataSetHeader& h) { h.rows = h.rows + 1; }),
+      Edit([](BinaryDataSetHeader& h) { h.cols = big; }),
+      Edit([](BinaryDataSetHeader& h) { h.cols = h.cols * 1000; }),
+      // offsets that wrap back into range when a size is added
+      Edit([](BinaryDataSetHeader& h) { h.dataOffset = big - 63; }),
+      Edit([](BinaryDataSetHeader& h) { h.idsOffset = big - 7; }),
+      Edit([](BinaryDataSetHeader& h) { h.idsSize = big; }),
+      Edit([](BinaryDataSetHeader& h) { h.idsSize = 8; }),
+      Edit([](BinaryDataSetHeader& h) { h.dataOffset = 0; }),
+      Edit([](BinaryDataSetHeader& h) { h.dataType = 7; }),
+      Edit([](BinaryDataSetHeader& h) { h.version = 0; }),
+      Edit([](BinaryDataSetHeader& h) { h.tag[0] = 'X'; }));
+
+  CHECK_FALSE(BinaryDataSetFile(withHeader(edit), "r").ok());
+}
+
+TEST_CASE("BinaryDataSetFile rejects id offsets outside the id blob",
+          "[BinaryDataSetFile]")
+{
+  std::string original = "TestFluidBinaryFile.bin";
+  std::string corrupt = "TestFluidBinaryFile_corrupt.bin";
+  REQUIRE(BinaryDataSetFile(original, "w").write(testDataSet()));
+  auto                bytes = readBytes(original);
+  BinaryDataSetHeader header;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+
+  std::uint64_t value = GENERATE(std::uint64_t(1000),
+                                 std::numeric_limits<std::uint64_t>::max());
+  std::memcpy(bytes.data() + header.idsOffset + sizeof(std::uint64_t), &value,
+              sizeof(value));
+  writeBytes(corrupt, bytes);
+  CHECK_FALSE(BinaryDataSetFile(corrupt, "r").ok());
+}
+
+TEST_CASE("BinaryDataSetFile rejects duplicate ids", "[BinaryDataSetFile]")
+{
+  std::string original = "TestFluidBinaryFile.bin";
+  std::string corrupt = "TestFluidBinaryFile_corrupt.bin";
+  FluidTensor<double, 2>      points{{0, 1}, {2, 3}, {4, 5}};
+  FluidTensor<std::string, 1> ids{"ab", "cd", "ef"};
+  REQUIRE(BinaryDataSetFile(original, "w").write(DataSet(ids, points)));
+
+  // rename the last id to match the first
+  auto bytes = readBytes(original);
+  bytes[bytes.size() - 2] = 'a';
+  bytes[bytes.size() - 1] = 'b';
+  writeBytes(corrupt, bytes);
+  BinaryDataSetFile file(corrupt, "r");
+  CHECK_FALSE(file.ok());
+  CHECK(file.size() == 0);
+}
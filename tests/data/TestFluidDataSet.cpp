@@ -155,6 +155,69 @@ TEST_CASE("FluidDataSet can have points removed","[FluidDataSet]")
     CHECK(d.get(labels(0),output) == false);
 }
 
+TEST_CASE("FluidDataSet lookups survive removal from the middle","[FluidDataSet]")
+{
+    FluidTensor<int, 2> points{{0,1,2,3,4},{5,6,7,8,9},{10,11,12,13,14}}; 
+    FluidTensor<std::string,1> labels{"zero","one","two"}; 
+    DataSet d(labels, points); 
+    FluidTensor<int, 1> output{-1,-1,-1,-1,-1}; 
+
+    CHECK(d.remove(labels(0)) == true); 
+    CHECK(d.size() == 2); 
+    CHECK(d.getData().size() == 10); 
+    CHECK(d.get(labels(0),output) == false); 
+
+    CHECK(d.get(labels(1),output) == true); 
+    REQUIRE_THAT(output,EqualsRange(points.row(1))); 
+    CHECK(d.get(labels(2),output) == true); 
+    REQUIRE_THAT(output,EqualsRange(points.row(2))); 
+
+    for(fluid::index i = 0; i < d.size(); i++)
+    {
+        CHECK(d.getIndex(d.getIds()(i)) == i); 
+        REQUIRE_THAT(d.getData().row(i),EqualsRange(d.get(d.getIds()(i)))); 
+    }
+
+    CHECK(d.remove(labels(2)) == true); 
+    CHECK(d.remove(labels(1)) == true); 
+    CHECK(d.size() == 0); 
+}
+
+TEST_CASE("FluidDataSet can add and remove points in bulk","[FluidDataSet]")
+{
+    FluidTensor<int, 2> points{{0,1,2,3,4},{5,6,7,8,9},{10,11,12,13,14}}; 
+    FluidTensor<std::string,1> labels{"zero","one","two"}; 
+    DataSet d(5); 
+    FluidTensor<int, 1> output{-1,-1,-1,-1,-1}; 
+
+    d.add(labels(1),points.row(1)); 
+    CHECK(d.addPoints(labels, points) == 2); 
+    CHECK(d.size() == 3); 
+    CHECK(d.getIds().size() == 3); 
+    CHECK(d.getData().size() == 15); 
+    for(fluid::index i = 0; i < 3; i++)
+    {
+        CHECK(d.get(labels(i),output) == true); 
+        REQUIRE_THAT(output,EqualsRange(points.row(i))); 
+    }
+
+    CHECK(d.addPoints(labels, points) == 0); 
+    CHECK(d.size() == 3); 
+
+    FluidTensor<int, 2> narrow{{0,1,2,3},{5,6,7,8}}; 
+    FluidTensor<std::string,1> newLabels{"three","four"}; 
+    CHECK(d.addPoints(newLabels, narrow) == 0); 
+    CHECK(d.addPoints(newLabels, points) == 0); 
+    CHECK(d.size() == 3); 
+    CHECK(d.getData().size() == 15); 
+
+    FluidTensor<std::string,1> toRemove{"two","three","zero"}; 
+    CHECK(d.removePoints(toRemove) == 2); 
+    CHECK(d.size() == 1); 
+    CHECK(d.get(labels(1),output) == true); 
+    REQUIRE_THAT(output,EqualsRange(points.row(1))); 
+}
+
 TEST_CASE("FluidDataSet prints consistent summaries for approval","[FluidDataSet]")
 {
     using namespace ApprovalTests; 
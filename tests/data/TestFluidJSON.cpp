@@ -0,0 +1,98 @@
+#define CATCH_CONFIG_MAIN
+
+#include <catch2/catch.hpp>
+#include <data/FluidDataSet.hpp>
+#include <data/FluidJSON.hpp>
+#include <data/FluidTensor.hpp>
+#include <CatchUtils.hpp>
+#include <sstream>
+#include <string>
+
+using fluid::EqualsRange;
+using fluid::FluidTensor;
+using DataSet = fluid::FluidDataSet<std::string, double, 1>;
+using LabelSet = fluid::FluidDataSet<std::string, std::string, 1>;
+
+TEST_CASE("DataSet JSON round trips through the streaming reader and writer",
+          "[FluidJSON]")
+{
+  bool                        pretty = GENERATE(true, false);
+  FluidTensor<double, 2>      points{{0.5, 1, -2}, {3, 4.25, 1e-300}};
+  FluidTensor<std::string, 1> ids{"zero", "with \"quotes\""};
+  DataSet                     original(ids, points);
+
+  std::stringstream stream;
+  fluid::write_json(stream, original, pretty);
+  DataSet copy;
+  REQUIRE(fluid::read_json(stream, copy));
+  REQUIRE(copy.size() == original.size());
+  REQUIRE(copy.dims() == original.dims());
+  for (fluid::index i = 0; i < original.size(); i++)
+  {
+    auto id = ids(i);
+    REQUIRE_THAT(copy.get(id), EqualsRange(original.get(id)));
+  }
+
+  // and agrees with the DOM parser
+  auto dom = nlohmann::json::parse(stream.str());
+  CHECK(dom["cols"] == 3);
+  CHECK(dom["data"]["zero"] == nlohmann::json{0.5, 1, -2});
+}
+
+TEST_CASE("LabelSet JSON round trips through the streaming reader and writer",
+          "[FluidJSON]")
+{
+  FluidTensor<std::string, 2> labels{{"a"}, {"b"}, {"a"}};
+  FluidTensor<std::string, 1> ids{"0", "1", "2"};
+  LabelSet                    original(ids, labels);
+
+  std::stringstream stream;
+  fluid::write_json(stream, original);
+  LabelSet copy;
+  REQUIRE(fluid::read_json(stream, copy));
+  REQUIRE(copy.size() == 3);
+  for (fluid::index i = 0; i < original.size(); i++)
+    REQUIRE_THAT(copy.get(ids(i)), EqualsRange(original.get(ids(i))));
+}
+
+TEST_CASE("DataSet JSON reader accepts cols after data and unknown keys",
+          "[FluidJSON]")
+{
+  DataSet ds;
+  REQUIRE(fluid::read_json(
+      std::string(R"({"meta": {"x": [1, {"y": 2}]}, "data": {"a": [1, 2]},)"
+                  R"( "cols": 2, "note": "ok"})"),
+      ds));
+  CHECK(ds.size() == 1);
+  CHECK(ds.dims() == 2);
+}
+
+TEST_CASE("DataSet JSON reader rejects malformed input", "[FluidJSON]")
+{
+  std::string input = GENERATE(
+      // missing cols
+      std::string(R"({"data": {"a": [1, 2]}})"),
+      // missing data
+      std::string(R"({"cols": 2})"),
+      // rows of the wrong length
+      std::string(R"({"cols": 2, "data": {"a": [1, 2, 3]}})"),
+      std::string(R"({"data": {"a": [1, 2], "b": [1]}, "cols": 2})"),
+      std::string(R"({"data": {"a": [1, 2]}, "cols": 3})"),
+      // duplicate ids
+      std::string(R"({"cols": 2, "data": {"a": [1, 2], "a": [3, 4]}})"),
+      // wrong types
+      std::string(R"({"cols": 2, "data": {"a": [1, "b"]}})"),
+      std::string(R"({"cols": 2, "data": {"a": [1, [2]]}})"),
+      std::string(R"({"cols": 2, "data": {"a": 1}})"),
+      std::string(R"({"cols": "2", "data": {}})"),
+      std::string(R"({"cols": -1, "data": {}})"),
+      // not JSON
+      std::string(R"({"cols": 2, "data": {"a": [1, 2])"),
+      std::string(""));
+
+  DataSet ds(1);
+  CHECK_FALSE(fluid::read_json(input, ds));
+  // a failed read leaves the target untouched
+  CHECK(ds.dims() == 1);
+  CHECK(ds.size() == 0);
+}